@@ -21,12 +21,28 @@ void testApp::setup(){
     
     warp.allocate(ofGetWidth(), ofGetHeight(), 5, 4, 80);
     
+    // soft edges on the left and right (eg., for a projector in the middle
+    // of three) that also even out brightness where the warp stretches
+    mask.setBlend(0.15f, 0.15f, 0.0f, 0.0f);
+    mask.setCompensation(1.0f);
+    bUseMask = false;
+    
+    controlThread.channel = &channel;
+    
     ofBackground(0, 0, 0);
 }
 
+//--------------------------------------------------------------
+void testApp::exit(){
+    controlThread.waitForThread(true);
+}
+
 //--------------------------------------------------------------
 void testApp::update(){
     
+    // whatever the control thread published last (if it's new) - never waits
+    channel.apply(warp);
+    
     vid.update();
     
     if(bUseWarp){
@@ -49,6 +65,11 @@ void testApp::draw(){
     if(bUseWarp){
         // draw using the bezier warp
         warp.draw();
+        if(bUseMask){
+            // only rebuilt when the warp changes
+            mask.update(warp.getMesh(), warp.getWidth(), warp.getHeight(), ofGetWidth(), ofGetHeight());
+            mask.draw(0, 0, ofGetWidth(), ofGetHeight());
+        }
     }else{
         // draw the video without the warp
         vid.draw(0, 0, ofGetWidth(), ofGetHeight());
@@ -59,9 +80,33 @@ void testApp::draw(){
     os << "Press 'w' to toggle using warp" << endl;
     os << "Press 'r' to reset the warp grid" << endl;
     os << "Press 's' to show the warp grid" << endl;
+    os << "Press 'm' to change warp mode (bezier, b-spline, catmull-rom)" << endl;
+    os << "Press 'a' to toggle adaptive tessellation (" << warp.getMesh().getNumVertices() << " vertices)" << endl;
+    os << "Press 't' to toggle tessellating on a background thread" << endl;
+    os << "Press 'k' to save the warp preset and 'l' to load it" << endl;
+    os << "Press 'b' to benchmark the CPU remap kernels" << endl;
+    os << "Press 'e' to toggle edge blending and brightness compensation" << endl;
+    os << "Press 'f' to benchmark the fixed size 2x2, 3x3 and 4x4 evaluators" << endl;
+    os << "Press 'c' to calibrate the warp against a (synthetic) camera" << endl;
+    os << "Press 'g' to change what dragging edits (control points or lattice level 1-" << warp.getLattice().getNumLevels() << ", now " << warp.getEditLevel() << ", " << warp.getLattice().getNumEdits() << " edits)" << endl;
+    os << "Press 'o' to drive the warp from a control thread (" << channel.getAppliedVersion() << " applied of " << channel.getNumPublished() << " published)" << endl;
+    os << "Press 'i' to change how the mesh indices are drawn (triangles, tiled, forsyth, strips)" << endl;
     os << "Use arrow keys to increase/decrease number of warp control points" << endl;
     os << endl;
-    os << "FPS: " << ofGetFrameRate();
+    os << "FPS: " << ofGetFrameRate() << endl;
+    
+    // how well the drawn indices use a 16 vertex post transform cache
+    ofxBezierWarpMesh & mesh = warp.getMesh();
+    const char * indexOutputs[] = {"triangles", "tiled", "forsyth", "strips"};
+    os << "Indices: " << indexOutputs[mesh.getIndexOutput()] << ", " << mesh.getNumDrawIndices() << " x " << mesh.getDrawIndexSize() * 8 << " bit, ACMR " << mesh.getDrawACMR(16) << endl;
+    
+    // which bit of the video is under the mouse, through the warp
+    ofPoint source;
+    if(bUseWarp && warp.getSourceAt(mouseX, mouseY, source)){
+        os << "Source under the mouse: " << (int)source.x << ", " << (int)source.y << endl;
+    }
+    
+    os << benchmarkResult;
     ofDrawBitmapString(os.str(), 20, 20);
 }
 
@@ -77,6 +122,50 @@ void testApp::keyPressed(int key){
         case 's':
             warp.toggleShowWarpGrid();
             break;
+        case 'm':
+            warp.setWarpMode((ofxBezierWarpMode)((warp.getWarpMode() + 1) % 3));
+            break;
+        case 'a':
+            warp.setWarpGridAdaptive(!warp.getWarpGridAdaptive());
+            break;
+        case 't':
+            warp.setUseBackgroundThread(!warp.getUseBackgroundThread());
+            break;
+        case 'k':
+            warp.savePreset("warp.bwp");
+            warp.savePresetText("warp.txt");
+            break;
+        case 'l':
+            warp.loadPreset("warp.bwp");
+            break;
+        case 'b':
+            benchmarkRemap();
+            break;
+        case 'e':
+            bUseMask = !bUseMask;
+            break;
+        case 'f':
+            benchmarkEvaluators();
+            break;
+        case 'c':
+            calibrateSynthetic();
+            break;
+        case 'o':
+            if(controlThread.isThreadRunning()){
+                controlThread.waitForThread(true);
+            }else{
+                controlThread.cntrlPoints = warp.getControlPointsReference();
+                controlThread.numXPoints = warp.getNumXPoints();
+                controlThread.numYPoints = warp.getNumYPoints();
+                controlThread.startThread(true, false);
+            }
+            break;
+        case 'g':
+            warp.setEditLevel((warp.getEditLevel() + 1) % (warp.getLattice().getNumLevels() + 1));
+            break;
+        case 'i':
+            warp.setIndexOutput((ofxBezierWarpIndexOutput)((warp.getIndexOutput() + 1) % 4));
+            break;
         case 'p':
             warp.setWarpGridPosition(100, 100, (ofGetWidth() - 200), (ofGetHeight() - 200));
             break;
@@ -95,6 +184,128 @@ void testApp::keyPressed(int key){
     }
 }
 
+//--------------------------------------------------------------
+void testApp::benchmarkRemap(){
+    
+    // time the row and tiled cpu kernels on an rgba frame the size
+    // of the warp - the first remap of each builds the lookup table
+    
+    ofPixels src, dst;
+    src.allocate(warp.getWidth(), warp.getHeight(), OF_IMAGE_COLOR_ALPHA);
+    unsigned char * pixels = src.getPixels();
+    for(int i = 0; i < src.getWidth() * src.getHeight() * 4; i++) pixels[i] = ofRandom(255);
+    
+    int numFrames = 10;
+    float times[2];
+    
+    for(int k = 0; k < 2; k++){
+        remap.setKernel((ofxBezierWarpRemapKernel)k);
+        remap.remap(warp, src, dst);
+        unsigned long long start = ofGetElapsedTimeMicros();
+        for(int i = 0; i < numFrames; i++) remap.remap(warp, src, dst);
+        times[k] = (ofGetElapsedTimeMicros() - start) / (numFrames * 1000.0f);
+    }
+    
+    ostringstream os;
+    os << "remap rows: " << times[0] << "ms tiled: " << times[1] << "ms (x" << times[0] / times[1] << ")";
+    benchmarkResult = os.str();
+    ofLogNotice() << benchmarkResult;
+}
+
+//--------------------------------------------------------------
+void testApp::benchmarkEvaluators(){
+    
+    // rebuild a bezier mesh at the warp's size with the generic and the
+    // fixed size evaluators - one point moves a little every rebuild
+    
+    int numFrames = 100;
+    int gridDivX = warp.getWidth() / 10;
+    int gridDivY = warp.getHeight() / 10;
+    
+    ostringstream os;
+    os << "evaluate";
+    
+    for(int n = 2; n <= 4; n++){
+        
+        vector<GLfloat> cntrlPoints(n * n * 3);
+        for(int j = 0; j < n; j++){
+            for(int i = 0; i < n; i++){
+                cntrlPoints[(j*n+i)*3+0] = warp.getWidth() * i / (n - 1) + ofRandom(-50, 50);
+                cntrlPoints[(j*n+i)*3+1] = warp.getHeight() * j / (n - 1) + ofRandom(-50, 50);
+                cntrlPoints[(j*n+i)*3+2] = 0;
+            }
+        }
+        
+        float times[2];
+        
+        for(int k = 0; k < 2; k++){
+            ofxBezierWarpMesh mesh;
+            mesh.setUseFixedEvaluators(k == 1);
+            mesh.update(cntrlPoints, n, n, gridDivX, gridDivY);
+            unsigned long long start = ofGetElapsedTimeMicros();
+            for(int i = 0; i < numFrames; i++){
+                cntrlPoints[0] += (i % 2 == 0) ? 0.5f : -0.5f;
+                mesh.update(cntrlPoints, n, n, gridDivX, gridDivY);
+            }
+            times[k] = (ofGetElapsedTimeMicros() - start) / (numFrames * 1000.0f);
+        }
+        
+        os << " " << n << "x" << n << ": " << times[0] << "ms -> " << times[1] << "ms (x" << times[0] / times[1] << ")";
+    }
+    
+    benchmarkResult = os.str();
+    ofLogNotice() << benchmarkResult;
+}
+
+//--------------------------------------------------------------
+void testApp::calibrateSynthetic(){
+    
+    // stand in for a camera watching the projection: a randomly bent
+    // copy of the warp "observes" where a few hundred source positions
+    // land (with a bit of noise) and the net is fitted to them
+    
+    vector<GLfloat> target = warp.getControlPointsReference();
+    for(size_t i = 0; i < target.size(); i += 3){
+        target[i+0] += ofRandom(-30, 30);
+        target[i+1] += ofRandom(-30, 30);
+    }
+    
+    calibration.setup(warp);
+    calibration.setSmoothness(0.01f);
+    
+    int numObservations = 300;
+    for(int i = 0; i < numObservations; i++){
+        float u = ofRandom(1), v = ofRandom(1);
+        GLfloat p[3];
+        ofxBezierWarpMesh::evaluate(target, warp.getNumXPoints(), warp.getNumYPoints(), u, v, p, warp.getWarpMode());
+        calibration.addCorrespondence(ofPoint(u, v), ofPoint(p[0] + ofRandom(-0.5, 0.5), p[1] + ofRandom(-0.5, 0.5)));
+    }
+    
+    unsigned long long start = ofGetElapsedTimeMicros();
+    bool bSolved = calibration.solve();
+    float solveTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+    
+    // more observations coming in only update the factorization
+    for(int i = 0; i < 10; i++){
+        float u = ofRandom(1), v = ofRandom(1);
+        GLfloat p[3];
+        ofxBezierWarpMesh::evaluate(target, warp.getNumXPoints(), warp.getNumYPoints(), u, v, p, warp.getWarpMode());
+        calibration.addCorrespondence(ofPoint(u, v), ofPoint(p[0], p[1]));
+    }
+    
+    start = ofGetElapsedTimeMicros();
+    bSolved = calibration.solve() && bSolved;
+    float updateTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+    
+    if(bSolved) calibration.applyToWarp(warp);
+    
+    ostringstream os;
+    os << "calibrate " << calibration.getNumCorrespondences() << " points: " << solveTime << "ms, +10 points: "
+       << updateTime << "ms, rms error " << calibration.getError() << "px";
+    benchmarkResult = os.str();
+    ofLogNotice() << benchmarkResult;
+}
+
 //--------------------------------------------------------------
 void testApp::keyReleased(int key){
 
@@ -133,4 +344,23 @@ void testApp::gotMessage(ofMessage msg){
 //--------------------------------------------------------------
 void testApp::dragEvent(ofDragInfo dragInfo){ 
 
-}
\ No newline at end of file
+}
+
+//--------------------------------------------------------------
+void ControlThread::threadedFunction(){
+    
+    // wobble the points about much faster than the frame rate - only
+    // the newest net gets applied each frame
+    vector<GLfloat> moved = cntrlPoints;
+    
+    while(isThreadRunning()){
+        float t = ofGetElapsedTimef();
+        for(int i = 0; i < numXPoints * numYPoints; i++){
+            moved[i*3+0] = cntrlPoints[i*3+0] + 10.0f * sin(t * 2.0f + i);
+            moved[i*3+1] = cntrlPoints[i*3+1] + 10.0f * cos(t * 3.0f + i);
+        }
+        channel->setControlPoints(moved, numXPoints, numYPoints);
+        channel->publish();
+        ofSleepMillis(1);
+    }
+}
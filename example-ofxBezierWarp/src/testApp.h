@@ -2,6 +2,21 @@
 
 #include "ofMain.h"
 #include "ofxBezierWarp.h"
+#include "ofxBezierWarpRemap.h"
+#include "ofxBezierWarpCalibration.h"
+#include "ofxBezierWarpChannel.h"
+
+// stands in for an OSC or network thread sending control points
+class ControlThread : public ofThread {
+    
+	public:
+		void threadedFunction();
+    
+        ofxBezierWarpChannel * channel;
+        vector<GLfloat> cntrlPoints;
+        int numXPoints;
+        int numYPoints;
+};
 
 class testApp : public ofBaseApp{
 
@@ -9,6 +24,7 @@ class testApp : public ofBaseApp{
 		void setup();
 		void update();
 		void draw();
+		void exit();
 
 		void keyPressed  (int key);
 		void keyReleased(int key);
@@ -22,7 +38,22 @@ class testApp : public ofBaseApp{
     
         ofVideoPlayer vid;
     
+        void benchmarkRemap();
+        void benchmarkEvaluators();
+        void calibrateSynthetic();
+    
         ofxBezierWarp warp;
         bool bUseWarp;
+    
+        ofxBezierWarpRemap remap;
+        string benchmarkResult;
+    
+        ofxBezierWarpMask mask;
+        bool bUseMask;
+    
+        ofxBezierWarpCalibration calibration;
+    
+        ofxBezierWarpChannel channel;
+        ControlThread controlThread;
 		
 };
@@ -0,0 +1,117 @@
+#include "ofMain.h"
+#include "ofxBezierWarp.h"
+#include "ofxBezierWarpBatch.h"
+
+// headless command line warp for render nodes - no window or GL context,
+// everything goes through the CPU remap
+
+//========================================================================
+static void usage(){
+    cerr << "usage: example-ofxBezierWarpBatch preset.bwp input output [options]" << endl;
+    cerr << "  input/output are y4m (4:2:0 or mono) unless --raw is given, - for stdin/stdout" << endl;
+    cerr << "  --raw WxH FORMAT   raw frames, FORMAT is gray, rgb, rgba, i420, nv12 or p010" << endl;
+    cerr << "  --size WxH         output size (defaults to the input size)" << endl;
+    cerr << "  --threads N        remap threads (defaults to the number of cores)" << endl;
+    cerr << "  --queue N          frames in flight between read, remap and write (4)" << endl;
+    cerr << "  --frames N         stop after N frames" << endl;
+}
+
+//========================================================================
+static bool parseSize(string s, int & w, int & h){
+    vector<string> parts = ofSplitString(s, "x");
+    if(parts.size() != 2) return false;
+    w = ofToInt(parts[0]);
+    h = ofToInt(parts[1]);
+    return w > 0 && h > 0;
+}
+
+//========================================================================
+// the console channel prints anything below an error to stdout, which is
+// the video itself when writing to -
+class StderrLoggerChannel : public ofBaseLoggerChannel {
+public:
+    void log(ofLogLevel level, const string & module, const string & message){
+        fprintf(stderr, "[%s] %s%s%s\n", ofGetLogLevelName(level).c_str(), module.c_str(), module.empty() ? "" : ": ", message.c_str());
+    }
+    void log(ofLogLevel level, const string & module, const char * format, ...){
+        va_list args;
+        va_start(args, format);
+        log(level, module, format, args);
+        va_end(args);
+    }
+    void log(ofLogLevel level, const string & module, const char * format, va_list args){
+        fprintf(stderr, "[%s] %s%s", ofGetLogLevelName(level).c_str(), module.c_str(), module.empty() ? "" : ": ");
+        vfprintf(stderr, format, args);
+        fprintf(stderr, "\n");
+    }
+};
+
+//========================================================================
+int main(int argc, char * argv[]){
+    
+    if(argc < 4){
+        usage();
+        return 1;
+    }
+    
+    // paths are relative to where we're run from, not bin/data
+    ofSetDataPathRoot("./");
+    
+    // keep the log out of the video when it goes to stdout
+    if(string(argv[3]) == "-") ofSetLoggerChannel(ofPtr<ofBaseLoggerChannel>(new StderrLoggerChannel()));
+    
+    ofxBezierWarpBatch batch;
+    
+    for(int i = 4; i < argc; i++){
+        string arg = argv[i];
+        bool bHasValue = i + 1 < argc;
+        int w = 0, h = 0;
+        if(arg == "--raw" && i + 2 < argc && parseSize(argv[i + 1], w, h)){
+            string f = argv[i + 2];
+            ofxBezierWarpBatchFormat format;
+            if(f == "gray"){
+                format = OFX_BEZIER_WARP_BATCH_GRAY;
+            }else if(f == "rgb"){
+                format = OFX_BEZIER_WARP_BATCH_RGB;
+            }else if(f == "rgba"){
+                format = OFX_BEZIER_WARP_BATCH_RGBA;
+            }else if(f == "i420"){
+                format = OFX_BEZIER_WARP_BATCH_I420;
+            }else if(f == "nv12"){
+                format = OFX_BEZIER_WARP_BATCH_NV12;
+            }else if(f == "p010"){
+                format = OFX_BEZIER_WARP_BATCH_P010;
+            }else{
+                usage();
+                return 1;
+            }
+            batch.setInput(format, w, h);
+            i += 2;
+        }else if(arg == "--size" && bHasValue && parseSize(argv[i + 1], w, h)){
+            batch.setOutputSize(w, h);
+            i++;
+        }else if(arg == "--threads" && bHasValue){
+            batch.getRemap().setNumThreads(ofToInt(argv[++i]));
+        }else if(arg == "--queue" && bHasValue){
+            batch.setQueueSize(ofToInt(argv[++i]));
+        }else if(arg == "--frames" && bHasValue){
+            batch.setMaxFrames(ofToInt(argv[++i]));
+        }else{
+            usage();
+            return 1;
+        }
+    }
+    
+    ofxBezierWarp warp;
+    if(!warp.loadPreset(argv[1])){
+        cerr << "could not load warp preset " << argv[1] << endl;
+        return 1;
+    }
+    
+    bool bOk = batch.process(warp, argv[2], argv[3]);
+    
+    // stdout may be the video so the report goes to stderr
+    cerr << batch.getStatsString() << endl;
+    
+    return bOk ? 0 : 1;
+}
@@ -33,25 +33,32 @@
  */
 
 #include "ofxBezierWarp.h"
-
-GLfloat texpts [2][2][2] = {
-    { {0, 0}, {1, 0} },	{ {0, 1}, {1, 1} }
-};
+#include "ofxBezierWarpPreset.h"
 
 //--------------------------------------------------------------
 ofxBezierWarp::ofxBezierWarp(){
     currentCntrlX = -1;
     currentCntrlY = -1;
+    currentNodeX = -1;
+    currentNodeY = -1;
+    editLevel = 0;
+    hitRadius = 10.0f;
     numXPoints = 0;
     numYPoints = 0;
+    width = 0;
+    height = 0;
     warpX = 0;
     warpY = 0;
     warpWidth = 0;
     warpHeight = 0;
     gridResolution = -1;
+    gridDivX = 0;
+    gridDivY = 0;
+    warpMode = OFX_BEZIER_WARP_BEZIER;
     bShowWarpGrid = false;
     bWarpPositionDiff = false;
     bDoWarp = true;
+    bUseBackgroundThread = false;
 }
 
 //--------------------------------------------------------------
@@ -81,22 +88,37 @@ void ofxBezierWarp::allocate(int _w, int _h, int _numXPoints, int _numYPoints, f
         ofLogVerbose() << "Allocating bezier fbo texture as: " << fbo.getWidth() << " x " << fbo.getHeight();
     }
 
-    setWarpGrid(_numXPoints, _numYPoints);
-
-    //set up texture map for bezier surface
-    glMap2f(GL_MAP2_TEXTURE_COORD_2, 0, 1, 2, 2, 0, 1, 4, 2, &texpts[0][0][0]);
-    glEnable(GL_MAP2_TEXTURE_COORD_2);
-    glEnable(GL_MAP2_VERTEX_3);
-    glEnable(GL_AUTO_NORMAL);
-
-    setWarpGridResolution(pixelsPerGridDivision);
+    setup(_w, _h, _numXPoints, _numYPoints, pixelsPerGridDivision);
     
     //glShadeModel(GL_FLAT);
 
 }
 
+//--------------------------------------------------------------
+void ofxBezierWarp::setup(int _w, int _h, int _numXPoints, int _numYPoints, float pixelsPerGridDivision){
+    
+    // sets up the warp grid without allocating an fbo so the warp
+    // can be used with the CPU remap on machines without a GPU
+    
+    if(_w == 0 || _h == 0 || _numXPoints == 0 || _numYPoints == 0){
+        ofLogError() << "Cannot accept 0 as value for w, h numXPoints or numYPoints";
+        return;
+    }
+    
+    width = _w;
+    height = _h;
+    
+    setWarpGrid(_numXPoints, _numYPoints);
+    
+    // edits are in uv so they survive the grid changing size
+    if(!lattice.isSetup()) lattice.setup(numXPoints - 1, numYPoints - 1);
+    
+    setWarpGridResolution(pixelsPerGridDivision);
+}
+
 //--------------------------------------------------------------
 void ofxBezierWarp::begin(){
+    dirtyRects.clear();
     fbo.begin();
     ofPushMatrix();
     glClearColor(0.0, 0.0, 0.0, 1.0);
@@ -129,15 +151,13 @@ void ofxBezierWarp::draw(float x, float y, float w, float h){
     if(bDoWarp){
         
         ofTranslate(x, y);
-        ofScale(w/fbo.getWidth(), h/fbo.getHeight());
+        ofScale(w/width, h/height);
         
         ofTexture & fboTex = fbo.getTextureReference();
         
-        // upload the bezier control points to the map surface
-        // this can be done just once (or when control points change)
-        // if there is only one bezier surface - but with multiple
-        // it needs to be done every frame
-        glMap2f(GL_MAP2_VERTEX_3, 0, 1, 3, numXPoints, 0, 1, numXPoints * 3, numYPoints, &(cntrlPoints[0]));
+        // only re-evaluates the surface if the control points
+        // or grid divisions have changed since the last draw
+        ofxBezierWarpMesh & currentMesh = updateMesh();
         
         fboTex.bind();
         
@@ -148,11 +168,7 @@ void ofxBezierWarp::draw(float x, float y, float w, float h){
         glScalef(fboTex.getWidth(), fboTex.getHeight(), 1.0f);
         glMatrixMode(GL_MODELVIEW);
         
-//      glEnable(GL_MAP2_VERTEX_3);
-//      glEnable(GL_AUTO_NORMAL);
-        glEvalMesh2(GL_FILL, 0, gridDivX, 0, gridDivY);
-//      glDisable(GL_MAP2_VERTEX_3);
-//      glDisable(GL_AUTO_NORMAL);
+        currentMesh.draw();
         
         fboTex.unbind();
         
@@ -179,6 +195,15 @@ void ofxBezierWarp::draw(float x, float y, float w, float h){
 //    glFinish();
 }
 
+//--------------------------------------------------------------
+void ofxBezierWarp::drawWarpGrid(){
+    if(bWarpPositionDiff){
+        drawWarpGrid(warpX, warpY, warpWidth, warpHeight);
+    }else{
+        drawWarpGrid(0, 0, width, height);
+    }
+}
+
 //--------------------------------------------------------------
 void ofxBezierWarp::drawWarpGrid(float x, float y, float w, float h){
 
@@ -187,13 +212,26 @@ void ofxBezierWarp::drawWarpGrid(float x, float y, float w, float h){
 
     ofSetColor(255, 255, 255);
     ofTranslate(x, y);
-    ofScale(w/fbo.getWidth(), h/fbo.getHeight());
+    ofScale(w/width, h/height);
 
-//    glEnable(GL_MAP2_VERTEX_3);
-//    glEnable(GL_AUTO_NORMAL);
-    glEvalMesh2(GL_LINE, 0, gridDivX, 0, gridDivY);
-//    glDisable(GL_MAP2_VERTEX_3);
-//    glDisable(GL_AUTO_NORMAL);
+    updateMesh().drawWireframe();
+    
+    // the lattice nodes being edited, where they sit on the surface
+    int level = editLevel - 1;
+    for(int j = 0; j < lattice.getNumYNodes(level); j++){
+        for(int i = 0; i < lattice.getNumXNodes(level); i++){
+            ofPoint p = getLatticeNodePosition(level, i, j);
+            ofFill();
+            if(lattice.getOffset(level, i, j) != ofPoint()){
+                ofSetColor(255, 255, 0);
+                ofCircle(p.x, p.y, 4);
+            }else{
+                ofSetColor(0, 255, 0);
+                ofCircle(p.x, p.y, 2);
+            }
+            ofNoFill();
+        }
+    }
     
     for(int i = 0; i < numYPoints; i++){
         for(int j = 0; j < numXPoints; j++){
@@ -227,9 +265,9 @@ void ofxBezierWarp::setWarpGrid(int _numXPoints, int _numYPoints, bool forceRese
         cntrlPoints.resize(numXPoints * numYPoints * 3);
         for(int i = 0; i < numYPoints; i++){
             GLfloat x, y;
-            y = (fbo.getHeight() / (numYPoints - 1)) * i;
+            y = (height / (numYPoints - 1)) * i;
             for(int j = 0; j < numXPoints; j++){
-                x = (fbo.getWidth() / (numXPoints - 1)) * j;
+                x = (width / (numXPoints - 1)) * j;
                 cntrlPoints[(i*numXPoints+j)*3+0] = x;
                 cntrlPoints[(i*numXPoints+j)*3+1] = y;
                 cntrlPoints[(i*numXPoints+j)*3+2] = 0;
@@ -237,8 +275,6 @@ void ofxBezierWarp::setWarpGrid(int _numXPoints, int _numYPoints, bool forceRese
             }
         }
     }
-
-    glMap2f(GL_MAP2_VERTEX_3, 0, 1, 3, numXPoints, 0, 1, numXPoints * 3, numYPoints, &(cntrlPoints[0]));
 }
 
 //--------------------------------------------------------------
@@ -250,10 +286,20 @@ void ofxBezierWarp::setWarpGridPosition(float x, float y, float w, float h){
     bWarpPositionDiff = true;
 }
 
+//--------------------------------------------------------------
+ofRectangle ofxBezierWarp::getWarpGridPosition(){
+    return ofRectangle(warpX, warpY, warpWidth, warpHeight);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getUseWarpGridPosition(){
+    return bWarpPositionDiff;
+}
+
 //--------------------------------------------------------------
 void ofxBezierWarp::setWarpGridResolution(float pixelsPerGridDivision){
     gridResolution = pixelsPerGridDivision;
-    setWarpGridResolution(ceil(fbo.getWidth() / pixelsPerGridDivision), ceil(fbo.getHeight() / pixelsPerGridDivision));
+    setWarpGridResolution(ceil(width / pixelsPerGridDivision), ceil(height / pixelsPerGridDivision));
 }
 
 //--------------------------------------------------------------
@@ -264,19 +310,51 @@ float ofxBezierWarp::getWarpGridResolution(){
 
 //--------------------------------------------------------------
 void ofxBezierWarp::setWarpGridResolution(int gridDivisionsX, int gridDivisionsY){
-    // NB: at the moment this sets the resolution for all mapGrid
-    // objects (since I'm not calling it every frame as it is expensive)
-    // so if you try to set different resolutions
-    // for different instances it won't work as expected
+    // the resolution belongs to this instance only (the mesh is
+    // tessellated on the CPU rather than with glMapGrid2f) so
+    // different warps can use different resolutions
+    
+    if(gridDivisionsX < 1 || gridDivisionsY < 1){
+        ofLogError() << "Can't have less than 1 X or Y grid division";
+        return;
+    }
     
     gridDivX = gridDivisionsX;
     gridDivY = gridDivisionsY;
-    glMapGrid2f(gridDivX, 0, 1, gridDivY, 0, 1);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setWarpGridAdaptive(bool b, float tolerance){
+    mesh.setAdaptive(b, tolerance);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getWarpGridAdaptive(){
+    return mesh.getAdaptive();
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarp::getWarpGridTolerance(){
+    return mesh.getTolerance();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setWarpMode(ofxBezierWarpMode mode){
+    // the patch modes use the same control points as the single
+    // bezier surface so switching doesn't reset the grid - but the
+    // catmull-rom mode passes through the points so the shape changes
+    warpMode = mode;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMode ofxBezierWarp::getWarpMode(){
+    return warpMode;
 }
 
 //--------------------------------------------------------------
 void ofxBezierWarp::resetWarpGrid(){
     setWarpGrid(numXPoints, numYPoints, true);
+    lattice.clear();
 }
 
 //--------------------------------------------------------------
@@ -286,12 +364,12 @@ void ofxBezierWarp::resetWarpGridPosition(){
 
 //--------------------------------------------------------------
 float ofxBezierWarp::getWidth(){
-    return fbo.getWidth();
+    return width;
 }
 
 //--------------------------------------------------------------
 float ofxBezierWarp::getHeight(){
-    return fbo.getHeight();
+    return height;
 }
 
 //--------------------------------------------------------------
@@ -359,11 +437,148 @@ ofTexture& ofxBezierWarp::getTextureReference(){
     return fbo.getTextureReference();
 }
 
+//--------------------------------------------------------------
+ofxBezierWarpMesh& ofxBezierWarp::getMesh(){
+    return updateMesh();
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMesh& ofxBezierWarp::updateMesh(){
+    
+    if(!bUseBackgroundThread){
+        mesh.update(cntrlPoints, numXPoints, numYPoints, gridDivX, gridDivY, warpMode, &lattice);
+        return mesh;
+    }
+    
+    // the adaptive and other mesh settings live on the mesh so pass them along
+    tessellator.setMeshOptions(mesh.getUseSIMD(), mesh.getUseFixedEvaluators(), mesh.getIndexOutput(),
+                               mesh.getUseShortIndices(), mesh.getUsePrimitiveRestart(), mesh.getVertexCacheSize());
+    tessellator.update(cntrlPoints, numXPoints, numYPoints, gridDivX, gridDivY, warpMode,
+                       mesh.getAdaptive(), mesh.getTolerance(), &lattice);
+    
+    // only ever wait for the very first mesh so nothing blinks
+    // when the thread is turned on - after that it's whatever is ready
+    if(!tessellator.getMesh().isAllocated()) tessellator.flush();
+    
+    return tessellator.getMesh();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setUseSIMD(bool b){
+    mesh.setUseSIMD(b);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getUseSIMD(){
+    return mesh.getUseSIMD();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setUseFixedEvaluators(bool b){
+    mesh.setUseFixedEvaluators(b);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getUseFixedEvaluators(){
+    return mesh.getUseFixedEvaluators();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setIndexOutput(ofxBezierWarpIndexOutput output){
+    mesh.setIndexOutput(output);
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpIndexOutput ofxBezierWarp::getIndexOutput(){
+    return mesh.getIndexOutput();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setUseShortIndices(bool b){
+    mesh.setUseShortIndices(b);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getUseShortIndices(){
+    return mesh.getUseShortIndices();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setUsePrimitiveRestart(bool b){
+    mesh.setUsePrimitiveRestart(b);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getUsePrimitiveRestart(){
+    return mesh.getUsePrimitiveRestart();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setVertexCacheSize(int size){
+    mesh.setVertexCacheSize(size);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarp::getVertexCacheSize(){
+    return mesh.getVertexCacheSize();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setUseBackgroundThread(bool b){
+    bUseBackgroundThread = b;
+    if(bUseBackgroundThread){
+        tessellator.start();
+    }else{
+        tessellator.stop();
+    }
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getUseBackgroundThread(){
+    return bUseBackgroundThread;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::addDirtyRect(ofRectangle rect){
+    dirtyRects.push_back(rect);
+}
+
+//--------------------------------------------------------------
+vector<ofRectangle>& ofxBezierWarp::getDirtyRectsReference(){
+    return dirtyRects;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpTessellator& ofxBezierWarp::getTessellator(){
+    return tessellator;
+}
+
 //--------------------------------------------------------------
 void ofxBezierWarp::setControlPoints(vector<GLfloat> _cntrlPoints){
     cntrlPoints.clear();
     cntrlPoints = _cntrlPoints;
-    glMap2f(GL_MAP2_VERTEX_3, 0, 1, 3, numXPoints, 0, 1, numXPoints * 3, numYPoints, &(cntrlPoints[0]));
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::savePreset(string path){
+    ofxBezierWarpPreset preset;
+    preset.setFromWarp(*this);
+    return preset.save(path);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::loadPreset(string path){
+    ofxBezierWarpPreset preset;
+    if(!preset.load(path)) return false;
+    preset.applyToWarp(*this);
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::savePresetText(string path){
+    ofxBezierWarpPreset preset;
+    preset.setFromWarp(*this);
+    return preset.saveText(path);
 }
 
 //--------------------------------------------------------------
@@ -401,18 +616,16 @@ void ofxBezierWarp::mouseDragged(ofMouseEventArgs & e){
 
     if(!bShowWarpGrid) mouseReleased(e);
 
-    float x = e.x;
-    float y = e.y;
-
-    if(bWarpPositionDiff){
-        x = (e.x - warpX) * fbo.getWidth()/warpWidth;
-        y = (e.y - warpY) * fbo.getHeight()/warpHeight;
-    }
+    ofPoint p = screenToWarp(e.x, e.y);
 
     if(currentCntrlX != -1 && currentCntrlY != -1){
-        cntrlPoints[(currentCntrlX*numXPoints+currentCntrlY)*3+0] = x;
-        cntrlPoints[(currentCntrlX*numXPoints+currentCntrlY)*3+1] = y;
-        glMap2f(GL_MAP2_VERTEX_3, 0, 1, 3, numXPoints, 0, 1, numXPoints * 3, numYPoints, &(cntrlPoints[0]));
+        cntrlPoints[(currentCntrlX*numXPoints+currentCntrlY)*3+0] = p.x;
+        cntrlPoints[(currentCntrlX*numXPoints+currentCntrlY)*3+1] = p.y;
+    }
+    
+    if(currentNodeX != -1 && currentNodeY != -1){
+        ofPoint node = getLatticeNodePosition(editLevel - 1, currentNodeX, currentNodeY);
+        lattice.moveNode(editLevel - 1, currentNodeX, currentNodeY, ofPoint(p.x - node.x, p.y - node.y));
     }
 }
 
@@ -421,31 +634,145 @@ void ofxBezierWarp::mousePressed(ofMouseEventArgs & e){
 
     if(!bShowWarpGrid) mouseReleased(e);
 
-    float x = e.x;
-    float y = e.y;
+    if(editLevel > 0){
+        getLatticeNodeAt(e.x, e.y, editLevel - 1, currentNodeX, currentNodeY);
+        return;
+    }
 
-    if(bWarpPositionDiff){
-        x = (e.x - warpX) * fbo.getWidth()/warpWidth;
-        y = (e.y - warpY) * fbo.getHeight()/warpHeight;
+    int index = getControlPointAt(e.x, e.y);
+
+    if(index != -1){
+        currentCntrlX = index / numXPoints;
+        currentCntrlY = index % numXPoints;
     }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setHitRadius(float radius){
+    hitRadius = radius;
+}
 
-    float dist = 10.0f;
+//--------------------------------------------------------------
+float ofxBezierWarp::getHitRadius(){
+    return hitRadius;
+}
 
-    for(int i = 0; i < numYPoints; i++){
-        for(int j = 0; j < numXPoints; j++){
-            if(x - cntrlPoints[(i*numXPoints+j)*3+0] >= -dist && x - cntrlPoints[(i*numXPoints+j)*3+0] <= dist &&
-               y - cntrlPoints[(i*numXPoints+j)*3+1] >= -dist && y - cntrlPoints[(i*numXPoints+j)*3+1] <= dist){
-                currentCntrlX = i;
-                currentCntrlY = j;
+//--------------------------------------------------------------
+int ofxBezierWarp::getControlPointAt(float x, float y){
+    ofPoint p = screenToWarp(x, y);
+    ofPoint scale = getScreenScale();
+    pointIndex.update(cntrlPoints);
+    return pointIndex.findNearest(p.x, p.y, hitRadius, scale.x, scale.y);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::getControlPointsInRadius(float x, float y, float radius, vector<int>& indices){
+    ofPoint p = screenToWarp(x, y);
+    ofPoint scale = getScreenScale();
+    pointIndex.update(cntrlPoints);
+    pointIndex.findInRadius(p.x, p.y, radius, indices, scale.x, scale.y);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::getControlPointsInRect(ofRectangle rect, vector<int>& indices){
+    ofPoint p0 = screenToWarp(rect.x, rect.y);
+    ofPoint p1 = screenToWarp(rect.x + rect.width, rect.y + rect.height);
+    pointIndex.update(cntrlPoints);
+    pointIndex.findInRect(p0.x, p0.y, p1.x - p0.x, p1.y - p0.y, indices);
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLattice& ofxBezierWarp::getLattice(){
+    return lattice;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarp::setEditLevel(int level){
+    editLevel = ofClamp(level, 0, lattice.getNumLevels());
+    currentCntrlX = currentCntrlY = -1;
+    currentNodeX = currentNodeY = -1;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarp::getEditLevel(){
+    return editLevel;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getLatticeNodeAt(float x, float y, int level, int & i, int & j){
+    
+    // every node has to be put on the surface anyway to draw them
+    // so there's no point indexing them like the control points
+    ofPoint p = screenToWarp(x, y);
+    ofPoint scale = getScreenScale();
+    float nearestDistSq = hitRadius * hitRadius;
+    
+    i = j = -1;
+    
+    for(int nj = 0; nj < lattice.getNumYNodes(level); nj++){
+        for(int ni = 0; ni < lattice.getNumXNodes(level); ni++){
+            ofPoint node = getLatticeNodePosition(level, ni, nj);
+            float dx = (node.x - p.x) * scale.x;
+            float dy = (node.y - p.y) * scale.y;
+            if(dx * dx + dy * dy < nearestDistSq){
+                nearestDistSq = dx * dx + dy * dy;
+                i = ni;
+                j = nj;
             }
         }
     }
+    
+    return i != -1;
+}
+
+//--------------------------------------------------------------
+ofPoint ofxBezierWarp::getLatticeNodePosition(int level, int i, int j){
+    ofPoint uv = lattice.getNodeTexCoord(level, i, j);
+    GLfloat p[3];
+    ofxBezierWarpMesh::evaluate(cntrlPoints, numXPoints, numYPoints, uv.x, uv.y, p, warpMode);
+    lattice.addDisplacement(uv.x, uv.y, p);
+    return ofPoint(p[0], p[1], p[2]);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarp::getSourceAt(float x, float y, ofPoint & source){
+    ofPoint p = screenToWarp(x, y);
+    inverse.update(getMesh());
+    float u, v;
+    if(!inverse.find(p.x, p.y, u, v)) return false;
+    source.set(u * width, v * height);
+    return true;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpInverse& ofxBezierWarp::getInverse(){
+    return inverse;
+}
+
+//--------------------------------------------------------------
+ofPoint ofxBezierWarp::screenToWarp(float x, float y){
+    if(bWarpPositionDiff){
+        x = (x - warpX) * width/warpWidth;
+        y = (y - warpY) * height/warpHeight;
+    }
+    return ofPoint(x, y);
+}
+
+//--------------------------------------------------------------
+ofPoint ofxBezierWarp::getScreenScale(){
+    // how many screen pixels one warp pixel is drawn as
+    if(bWarpPositionDiff && width > 0 && height > 0){
+        return ofPoint(warpWidth/width, warpHeight/height);
+    }
+    return ofPoint(1.0f, 1.0f);
 }
 
 //--------------------------------------------------------------
 void ofxBezierWarp::mouseReleased(ofMouseEventArgs & e){
     currentCntrlX = -1;
     currentCntrlY = -1;
+    currentNodeX = -1;
+    currentNodeY = -1;
 }
 
 //--------------------------------------------------------------
@@ -37,6 +37,10 @@
 #include "ofFbo.h"
 #include "ofGraphics.h"
 #include "ofEvents.h"
+#include "ofxBezierWarpMesh.h"
+#include "ofxBezierWarpTessellator.h"
+#include "ofxBezierWarpPointIndex.h"
+#include "ofxBezierWarpInverse.h"
 
 class ofxBezierWarp {
     
@@ -48,6 +52,8 @@ public:
     void allocate(int w, int h, int pixelFormat = GL_RGBA);
     void allocate(int w, int h, int numXPoints, int numYPoints, float pixelsPerGridDivision, int pixelFormat = GL_RGBA);
     
+    void setup(int w, int h, int numXPoints, int numYPoints, float pixelsPerGridDivision);
+    
     void begin();
     void end();
     
@@ -57,10 +63,21 @@ public:
     
     void setWarpGrid(int numXPoints, int numYPoints, bool forceReset = false);
     void setWarpGridPosition(float x, float y, float w, float h);
+    ofRectangle getWarpGridPosition();
+    bool getUseWarpGridPosition();
     
     void setWarpGridResolution(float pixelsPerGridDivision);
     void setWarpGridResolution(int gridDivisionsX, int gridDivisionsY);
     
+    // only subdivide where the warp actually bends (the grid resolution
+    // becomes the finest it will go) - tolerance is in pixels
+    void setWarpGridAdaptive(bool b, float tolerance = 0.5f);
+    bool getWarpGridAdaptive();
+    float getWarpGridTolerance();
+    
+    void setWarpMode(ofxBezierWarpMode mode);
+    ofxBezierWarpMode getWarpMode();
+    
     void resetWarpGrid();
     void resetWarpGridPosition();
     
@@ -74,6 +91,10 @@ public:
     int getGridDivisionsX();
     int getGridDivisionsY();
     
+    // draws the control grid where the warp was last drawn (or
+    // wherever setWarpGridPosition put it)
+    void drawWarpGrid();
+    
     void toggleShowWarpGrid();
     void setShowWarpGrid(bool b);
     bool getShowWarpGrid();
@@ -91,11 +112,76 @@ public:
     
     ofTexture& getTextureReference();
     
+    ofxBezierWarpMesh& getMesh();
+    
+    // mesh settings (see ofxBezierWarpMesh) - set them here rather than
+    // through getMesh() which is one of the background thread's meshes
+    // while it's running
+    void setUseSIMD(bool b);
+    bool getUseSIMD();
+    void setUseFixedEvaluators(bool b);
+    bool getUseFixedEvaluators();
+    void setIndexOutput(ofxBezierWarpIndexOutput output);
+    ofxBezierWarpIndexOutput getIndexOutput();
+    void setUseShortIndices(bool b);
+    bool getUseShortIndices();
+    void setUsePrimitiveRestart(bool b);
+    bool getUsePrimitiveRestart();
+    void setVertexCacheSize(int size);
+    int getVertexCacheSize();
+    
+    // evaluate the mesh on a background thread - draw() (and getMesh())
+    // then use the most recently finished mesh instead of waiting for it
+    void setUseBackgroundThread(bool b);
+    bool getUseBackgroundThread();
+    
+    ofxBezierWarpTessellator& getTessellator();
+    
+    // finer control on top of the control points without raising the
+    // grid (see ofxBezierWarpLattice) - it's set up with the warp, its
+    // level 0 spanning the control points, and resetWarpGrid() clears it
+    ofxBezierWarpLattice& getLattice();
+    
+    // what dragging on the warp grid moves: 0 is the control points,
+    // 1 and up the nodes of lattice level (editLevel - 1)
+    void setEditLevel(int level);
+    int getEditLevel();
+    
+    // lattice nodes picked where they sit on the surface (screen space
+    // like getControlPointAt) - false if none is within the hit radius
+    bool getLatticeNodeAt(float x, float y, int level, int & i, int & j);
+    ofPoint getLatticeNodePosition(int level, int i, int j);
+    
+    // what changed in the content (in warp pixels) for incremental CPU
+    // remaps - mark it between begin() and end(), begin() starts afresh
+    void addDirtyRect(ofRectangle rect);
+    vector<ofRectangle>& getDirtyRectsReference();
+    
+    // see ofxBezierWarpPreset - binary for loading fast, text for diffing
+    bool savePreset(string path);
+    bool loadPreset(string path);
+    bool savePresetText(string path);
+    
     void setControlPoints(vector<GLfloat> controlPoints);
     
     vector<GLfloat> getControlPoints();
     vector<GLfloat>& getControlPointsReference();
     
+    // picking control points in screen space (ie., taking the warp grid
+    // position into account) - indices are into the control points
+    void setHitRadius(float radius);
+    float getHitRadius();
+    
+    int getControlPointAt(float x, float y);
+    void getControlPointsInRadius(float x, float y, float radius, vector<int>& indices);
+    void getControlPointsInRect(ofRectangle rect, vector<int>& indices);
+    
+    // the other way round from drawing: the point of the content (in warp
+    // pixels) that shows up at a point of the screen - false if none does.
+    // Querying getInverse() directly needs an update(getMesh()) first
+    bool getSourceAt(float x, float y, ofPoint & source);
+    ofxBezierWarpInverse& getInverse();
+    
     void mouseMoved(ofMouseEventArgs & e);
     void mouseDragged(ofMouseEventArgs & e);
     void mousePressed(ofMouseEventArgs & e);
@@ -106,17 +192,31 @@ public:
     
 protected:
 	
+    // presets need the grid resolution even when it isn't a single number
+    friend class ofxBezierWarpPreset;
+    
     void drawWarpGrid(float x, float y, float w, float h);
     
+    ofxBezierWarpMesh& updateMesh();
+    
+    ofPoint screenToWarp(float x, float y);
+    ofPoint getScreenScale();
+    
     bool bShowWarpGrid;
     bool bWarpPositionDiff;
     bool bDoWarp;
+    bool bUseBackgroundThread;
     
     ofFbo fbo;
     
+    vector<ofRectangle> dirtyRects;
+    
     ofPoint offset;
     ofPoint sOffset;
     
+    float width;
+    float height;
+    
     float warpWidth;
     float warpHeight;
     float warpX;
@@ -124,6 +224,13 @@ protected:
     
     int currentCntrlX;
     int currentCntrlY;
+    int currentNodeX;
+    int currentNodeY;
+    int editLevel;
+    
+    float hitRadius;
+    ofxBezierWarpPointIndex pointIndex;
+    ofxBezierWarpInverse inverse;
     
     int numXPoints;
     int numYPoints;
@@ -133,6 +240,11 @@ protected:
     int gridDivY;
     
     vector<GLfloat> cntrlPoints;
+    ofxBezierWarpLattice lattice;
+    
+    ofxBezierWarpMode warpMode;
+    ofxBezierWarpMesh mesh;
+    ofxBezierWarpTessellator tessellator;
     
 private:
 	
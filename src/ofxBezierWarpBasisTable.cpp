@@ -0,0 +1,220 @@
+/*
+ * ofxBezierWarpBasisTable.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpBasisTable.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpBasisTable::ofxBezierWarpBasisTable(){
+    mode = OFX_BEZIER_WARP_BEZIER;
+    numPoints = 0;
+    numDivisions = 0;
+    span = 0;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpBasisTable::~ofxBezierWarpBasisTable(){
+    clear();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBasisTable::setup(ofxBezierWarpMode _mode, int _numPoints, int _numDivisions){
+    
+    mode = _mode;
+    numPoints = _numPoints;
+    numDivisions = _numDivisions;
+    span = getBasisSpan(mode, numPoints);
+    
+    int numSamples = numDivisions + 1;
+    
+    first.resize(numSamples);
+    weights.resize(numSamples * span);
+    
+    sampleBegin.assign(numPoints, numSamples);
+    sampleEnd.assign(numPoints, 0);
+    columns.assign(numPoints * numSamples, 0.0f);
+    
+    for(int s = 0; s < numSamples; s++){
+        
+        float t = (float)s / numDivisions;
+        float * w = &weights[s * span];
+        
+        first[s] = getBasisWeights(mode, numPoints, t, w);
+        
+        for(int k = 0; k < span; k++){
+            int point = first[s] + k;
+            columns[point * numSamples + s] = w[k];
+            sampleBegin[point] = MIN(sampleBegin[point], s);
+            sampleEnd[point] = MAX(sampleEnd[point], s + 1);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpBasisTable::isSetup(ofxBezierWarpMode _mode, int _numPoints, int _numDivisions){
+    return span > 0 && mode == _mode && numPoints == _numPoints && numDivisions == _numDivisions;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBasisTable::clear(){
+    numPoints = 0;
+    numDivisions = 0;
+    span = 0;
+    first.clear();
+    weights.clear();
+    sampleBegin.clear();
+    sampleEnd.clear();
+    columns.clear();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getNumSamples(){
+    return numDivisions + 1;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getNumPoints(){
+    return numPoints;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getSpan(){
+    return span;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getFirst(int sample){
+    return first[sample];
+}
+
+//--------------------------------------------------------------
+const float * ofxBezierWarpBasisTable::getWeights(int sample){
+    return &weights[sample * span];
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getSampleBegin(int point){
+    return sampleBegin[point];
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getSampleEnd(int point){
+    return sampleEnd[point];
+}
+
+//--------------------------------------------------------------
+const float * ofxBezierWarpBasisTable::getColumn(int point){
+    return &columns[point * (numDivisions + 1)];
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBasisTable::getBernsteinWeights(int order, float t, float * weights){
+    
+    // de Casteljau style recurrence - numerically nicer than
+    // evaluating binomial(n, i) * t^i * (1-t)^(n-i) directly
+    
+    float s = 1.0f - t;
+    weights[0] = 1.0f;
+    for(int k = 1; k < order; k++){
+        weights[k] = t * weights[k - 1];
+        for(int i = k - 1; i > 0; i--){
+            weights[i] = s * weights[i] + t * weights[i - 1];
+        }
+        weights[0] = s * weights[0];
+    }
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getBasisSpan(ofxBezierWarpMode mode, int numPoints){
+    if(mode == OFX_BEZIER_WARP_BEZIER) return numPoints;
+    return MIN(4, numPoints);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBasisTable::getBasisWeights(ofxBezierWarpMode mode, int numPoints, float t, float * weights){
+    
+    // fills getBasisSpan() weights and returns the index of the
+    // first control point they apply to
+    
+    if(mode == OFX_BEZIER_WARP_BEZIER){
+        getBernsteinWeights(numPoints, t, weights);
+        return 0;
+    }
+    
+    // the patch modes have one cubic segment between each pair of
+    // neighbouring control points, each using the 4 points around it
+    
+    int numSegments = numPoints - 1;
+    float st = ofClamp(t, 0.0f, 1.0f) * numSegments;
+    int segment = MIN((int)st, numSegments - 1);
+    float s = st - segment;
+    float s2 = s * s;
+    float s3 = s2 * s;
+    
+    float w[4];
+    
+    if(mode == OFX_BEZIER_WARP_BSPLINE){
+        w[0] = (1.0f - 3.0f * s + 3.0f * s2 - s3) / 6.0f;
+        w[1] = (4.0f - 6.0f * s2 + 3.0f * s3) / 6.0f;
+        w[2] = (1.0f + 3.0f * s + 3.0f * s2 - 3.0f * s3) / 6.0f;
+        w[3] = s3 / 6.0f;
+    }else{
+        w[0] = (-s + 2.0f * s2 - s3) * 0.5f;
+        w[1] = (2.0f - 5.0f * s2 + 3.0f * s3) * 0.5f;
+        w[2] = (s + 4.0f * s2 - 3.0f * s3) * 0.5f;
+        w[3] = (-s2 + s3) * 0.5f;
+    }
+    
+    int span = getBasisSpan(mode, numPoints);
+    int first = MAX(0, MIN(segment - 1, numPoints - span));
+    
+    for(int k = 0; k < span; k++) weights[k] = 0.0f;
+    
+    // the points either side of the net are phantoms reflected
+    // through the edge points (P[-1] = 2 * P[0] - P[1]) so the
+    // surface reaches the corners of the control net
+    
+    for(int k = 0; k < 4; k++){
+        int idx = segment - 1 + k;
+        if(idx < 0){
+            weights[0 - first] += 2.0f * w[k];
+            weights[1 - first] -= w[k];
+        }else if(idx > numPoints - 1){
+            weights[numPoints - 1 - first] += 2.0f * w[k];
+            weights[numPoints - 2 - first] -= w[k];
+        }else{
+            weights[idx - first] += w[k];
+        }
+    }
+    
+    return first;
+}
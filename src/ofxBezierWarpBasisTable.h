@@ -0,0 +1,98 @@
+/*
+ * ofxBezierWarpBasisTable.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPBASISTABLE
+#define _H_OFXBEZIERWARPBASISTABLE
+
+#include "ofGraphics.h"
+
+enum ofxBezierWarpMode {
+    OFX_BEZIER_WARP_BEZIER = 0,     // one bezier surface of degree (numXPoints - 1) x (numYPoints - 1)
+    OFX_BEZIER_WARP_BSPLINE,        // lattice of uniform bicubic b-spline patches (smooth, approximating)
+    OFX_BEZIER_WARP_CATMULLROM      // lattice of bicubic catmull-rom patches (passes through the points)
+};
+
+// basis weights for every sample along one direction of the surface
+// ie., for numDivisions + 1 evenly spaced samples of t in [0, 1] and a
+// given number of control points - these never change for a given
+// resolution so they are worked out once and reused on every rebuild
+
+class ofxBezierWarpBasisTable {
+    
+public:
+	
+    ofxBezierWarpBasisTable();
+    ~ofxBezierWarpBasisTable();
+    
+    void setup(ofxBezierWarpMode mode, int numPoints, int numDivisions);
+    bool isSetup(ofxBezierWarpMode mode, int numPoints, int numDivisions);
+    void clear();
+    
+    int getNumSamples();
+    int getNumPoints();
+    int getSpan();
+    
+    // span weights for a sample starting at control point getFirst(sample)
+    int getFirst(int sample);
+    const float * getWeights(int sample);
+    
+    // the range of samples [begin, end) a control point contributes to and
+    // its weight at every sample (zero outside of that range)
+    int getSampleBegin(int point);
+    int getSampleEnd(int point);
+    const float * getColumn(int point);
+    
+    static void getBernsteinWeights(int order, float t, float * weights);
+    static int getBasisSpan(ofxBezierWarpMode mode, int numPoints);
+    static int getBasisWeights(ofxBezierWarpMode mode, int numPoints, float t, float * weights);
+    
+protected:
+	
+    ofxBezierWarpMode mode;
+    
+    int numPoints;
+    int numDivisions;
+    int span;
+    
+    vector<int> first;
+    vector<float> weights;
+    
+    vector<int> sampleBegin;
+    vector<int> sampleEnd;
+    vector<float> columns;
+    
+private:
+	
+};
+
+#endif
@@ -0,0 +1,492 @@
+/*
+ * ofxBezierWarpBatch.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpBatch.h"
+
+#ifdef TARGET_WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+//--------------------------------------------------------------
+ofxBezierWarpBatch::ofxBezierWarpBatch(){
+    inputFormat = OFX_BEZIER_WARP_BATCH_Y4M;
+    format = OFX_BEZIER_WARP_BATCH_Y4M;
+    inputWidth = inputHeight = 0;
+    outputWidth = outputHeight = 0;
+    dstWidth = dstHeight = 0;
+    queueSize = 4;
+    maxFrames = 0;
+    input = output = NULL;
+    bError = false;
+    readMicros = writeMicros = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpBatch::~ofxBezierWarpBatch(){
+    close();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::setInput(ofxBezierWarpBatchFormat format, int width, int height){
+    inputFormat = format;
+    inputWidth = width;
+    inputHeight = height;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpBatchFormat ofxBezierWarpBatch::getInputFormat(){
+    return inputFormat;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::setOutputSize(int width, int height){
+    outputWidth = width;
+    outputHeight = height;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::setQueueSize(int numFrames){
+    queueSize = MAX(numFrames, 1);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBatch::getQueueSize(){
+    return queueSize;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::setMaxFrames(int numFrames){
+    maxFrames = MAX(numFrames, 0);
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpRemap& ofxBezierWarpBatch::getRemap(){
+    return remap;
+}
+
+//--------------------------------------------------------------
+const ofxBezierWarpBatch::Stats& ofxBezierWarpBatch::getStats(){
+    return stats;
+}
+
+//--------------------------------------------------------------
+string ofxBezierWarpBatch::getStatsString(){
+    
+    // occupancy is the share of the run each stage was busy - the
+    // bottleneck sits near 100% and the others wait on it
+    double seconds = MAX(stats.seconds, 0.000001);
+    
+    char line[256];
+    sprintf(line, "%d frames in %.2fs (%.1f fps) - read %.0f%% remap %.0f%% write %.0f%% busy",
+            stats.numFrames, stats.seconds, stats.fps,
+            100.0 * stats.readSeconds / seconds,
+            100.0 * stats.remapSeconds / seconds,
+            100.0 * stats.writeSeconds / seconds);
+    
+    return string(line);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpBatch::getFrameSize(ofxBezierWarpBatchFormat format, int width, int height){
+    switch(format){
+        case OFX_BEZIER_WARP_BATCH_GRAY:
+            return width * height;
+        case OFX_BEZIER_WARP_BATCH_RGB:
+            return width * height * 3;
+        case OFX_BEZIER_WARP_BATCH_RGBA:
+            return width * height * 4;
+        case OFX_BEZIER_WARP_BATCH_I420:
+        case OFX_BEZIER_WARP_BATCH_Y4M:
+            return ofxBezierWarpRemap::getYUVSize(OFX_BEZIER_WARP_YUV_I420, width, height);
+        case OFX_BEZIER_WARP_BATCH_NV12:
+            return ofxBezierWarpRemap::getYUVSize(OFX_BEZIER_WARP_YUV_NV12, width, height);
+        case OFX_BEZIER_WARP_BATCH_P010:
+            return ofxBezierWarpRemap::getYUVSize(OFX_BEZIER_WARP_YUV_P010, width, height);
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpBatch::process(ofxBezierWarp & warp, string inputPath, string outputPath){
+    
+    memset(&stats, 0, sizeof(stats));
+    bError = false;
+    readMicros = writeMicros = 0;
+    
+    if(!open(inputPath, outputPath)) return false;
+    
+    if(!readHeader()){
+        close();
+        return false;
+    }
+    
+    // no size set means the input size - resolved per run so the next
+    // input with a different size doesn't inherit this one
+    bool bSameSize = outputWidth <= 0 || outputHeight <= 0;
+    dstWidth = bSameSize ? inputWidth : outputWidth;
+    dstHeight = bSameSize ? inputHeight : outputHeight;
+    
+    if(!writeHeader()){
+        close();
+        return false;
+    }
+    
+    // the only frames there are - they go round free -> read -> write -> free
+    vector<Frame> frames(queueSize);
+    for(int i = 0; i < queueSize; i++){
+        frames[i].src.resize(getFrameSize(format, inputWidth, inputHeight));
+        frames[i].dst.resize(getFrameSize(format, dstWidth, dstHeight));
+        frames[i].bLast = false;
+        freeQueue.push(&frames[i]);
+    }
+    
+    unsigned long long start = ofGetElapsedTimeMicros();
+    unsigned long long remapMicros = 0;
+    
+    Stage reader(this, true);
+    Stage writer(this, false);
+    reader.startThread(true, false);
+    writer.startThread(true, false);
+    
+    // remapping happens on this thread, spread over the remap's pool
+    while(true){
+        Frame * frame = readQueue.pop();
+        bool bLast = frame->bLast;
+        if(!bLast){
+            unsigned long long t = ofGetElapsedTimeMicros();
+            remapFrame(warp, *frame);
+            remapMicros += ofGetElapsedTimeMicros() - t;
+        }
+        // the frame belongs to the writer once it's pushed
+        writeQueue.push(frame);
+        if(bLast) break;
+    }
+    
+    reader.waitForThread(true);
+    writer.waitForThread(true);
+    
+    stats.seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+    stats.fps = stats.seconds > 0 ? stats.numFrames / stats.seconds : 0;
+    stats.readSeconds = readMicros / 1000000.0;
+    stats.remapSeconds = remapMicros / 1000000.0;
+    stats.writeSeconds = writeMicros / 1000000.0;
+    
+    freeQueue.frames.clear();
+    readQueue.frames.clear();
+    writeQueue.frames.clear();
+    
+    close();
+    
+    return !bError;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::readFrames(){
+    
+    int numRead = 0;
+    
+    while(true){
+        
+        Frame * frame = freeQueue.pop();
+        
+        unsigned long long t = ofGetElapsedTimeMicros();
+        bool bLast = bError || (maxFrames > 0 && numRead >= maxFrames) || !readFrame(*frame);
+        readMicros += ofGetElapsedTimeMicros() - t;
+        
+        frame->bLast = bLast;
+        readQueue.push(frame);
+        if(bLast) break;
+        
+        numRead++;
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::writeFrames(){
+    
+    while(true){
+        
+        Frame * frame = writeQueue.pop();
+        if(frame->bLast) break;
+        
+        // after an error keep the frames moving so the reader can see it and stop
+        if(!bError){
+            unsigned long long t = ofGetElapsedTimeMicros();
+            if(writeFrame(*frame)){
+                stats.numFrames++;
+            }else{
+                ofLogError() << "Could not write bezier warp batch frame " << stats.numFrames;
+                bError = true;
+            }
+            writeMicros += ofGetElapsedTimeMicros() - t;
+        }
+        
+        freeQueue.push(frame);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::remapFrame(ofxBezierWarp & warp, Frame & frame){
+    
+    const unsigned char * src = &frame.src[0];
+    unsigned char * dst = &frame.dst[0];
+    
+    switch(format){
+        case OFX_BEZIER_WARP_BATCH_GRAY:
+            remap.remap(warp, src, inputWidth, inputHeight, dst, dstWidth, dstHeight, 1);
+            break;
+        case OFX_BEZIER_WARP_BATCH_RGB:
+            remap.remap(warp, src, inputWidth, inputHeight, dst, dstWidth, dstHeight, 3);
+            break;
+        case OFX_BEZIER_WARP_BATCH_RGBA:
+            remap.remap(warp, src, inputWidth, inputHeight, dst, dstWidth, dstHeight, 4);
+            break;
+        case OFX_BEZIER_WARP_BATCH_I420:
+        case OFX_BEZIER_WARP_BATCH_Y4M:
+            remap.remapYUV(warp, OFX_BEZIER_WARP_YUV_I420, src, inputWidth, inputHeight, dst, dstWidth, dstHeight);
+            break;
+        case OFX_BEZIER_WARP_BATCH_NV12:
+            remap.remapYUV(warp, OFX_BEZIER_WARP_YUV_NV12, src, inputWidth, inputHeight, dst, dstWidth, dstHeight);
+            break;
+        case OFX_BEZIER_WARP_BATCH_P010:
+            remap.remapYUV(warp, OFX_BEZIER_WARP_YUV_P010, src, inputWidth, inputHeight, dst, dstWidth, dstHeight);
+            break;
+    }
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpBatch::open(string inputPath, string outputPath){
+    
+    close();
+    
+    if(inputPath == "-"){
+        input = stdin;
+    }else{
+        input = fopen(ofToDataPath(inputPath).c_str(), "rb");
+    }
+    
+    if(outputPath == "-"){
+        output = stdout;
+    }else{
+        output = fopen(ofToDataPath(outputPath).c_str(), "wb");
+    }
+    
+#ifdef TARGET_WIN32
+    if(input == stdin) _setmode(_fileno(stdin), _O_BINARY);
+    if(output == stdout) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    
+    if(input == NULL){
+        ofLogError() << "Could not open bezier warp batch input " << inputPath;
+    }
+    
+    if(output == NULL){
+        ofLogError() << "Could not open bezier warp batch output " << outputPath;
+    }
+    
+    if(input == NULL || output == NULL){
+        close();
+        return false;
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::close(){
+    if(input != NULL && input != stdin) fclose(input);
+    if(output != NULL && output != stdout) fclose(output);
+    if(output == stdout) fflush(stdout);
+    input = output = NULL;
+}
+
+//--------------------------------------------------------------
+static bool readLine(FILE * file, string & line){
+    line.clear();
+    int c;
+    while((c = fgetc(file)) != EOF && c != '\n'){
+        line += (char)c;
+        if(line.size() > 1024) return false;
+    }
+    return c == '\n';
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpBatch::readHeader(){
+    
+    format = inputFormat;
+    y4mParams.clear();
+    
+    if(format != OFX_BEZIER_WARP_BATCH_Y4M){
+        if(inputWidth <= 0 || inputHeight <= 0){
+            ofLogError() << "Raw bezier warp batch input needs a frame size";
+            return false;
+        }
+        return true;
+    }
+    
+    // YUV4MPEG2 W<width> H<height> [F, I, A, C, X params...]
+    string line;
+    if(!readLine(input, line) || line.compare(0, 10, "YUV4MPEG2 ") != 0){
+        ofLogError() << "Bezier warp batch input is not a y4m file";
+        return false;
+    }
+    
+    y4mParams = ofSplitString(line.substr(10), " ", true, true);
+    
+    format = OFX_BEZIER_WARP_BATCH_I420;
+    inputWidth = inputHeight = 0;
+    
+    for(size_t i = 0; i < y4mParams.size(); i++){
+        const string & param = y4mParams[i];
+        switch(param[0]){
+            case 'W':
+                inputWidth = ofToInt(param.substr(1));
+                break;
+            case 'H':
+                inputHeight = ofToInt(param.substr(1));
+                break;
+            case 'C':
+                // 420jpeg, 420paldv and 420mpeg2 only differ in chroma siting
+                // which we keep as it is, so are all the same to us
+                if(param == "Cmono"){
+                    format = OFX_BEZIER_WARP_BATCH_GRAY;
+                }else if(param != "C420" && param != "C420jpeg" && param != "C420paldv" && param != "C420mpeg2"){
+                    ofLogError() << "Unsupported y4m colour space " << param << " - only 8 bit 4:2:0 and mono";
+                    return false;
+                }
+                break;
+        }
+    }
+    
+    if(inputWidth <= 0 || inputHeight <= 0){
+        ofLogError() << "y4m header has no frame size";
+        return false;
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpBatch::readFrame(Frame & frame){
+    
+    if(inputFormat == OFX_BEZIER_WARP_BATCH_Y4M){
+        // FRAME [params] - we don't use any of them
+        string line;
+        if(!readLine(input, line)){
+            if(!line.empty()) ofLogWarning() << "Truncated y4m frame header";
+            return false;
+        }
+        if(line.compare(0, 5, "FRAME") != 0){
+            ofLogError() << "Bad y4m frame header " << line;
+            bError = true;
+            return false;
+        }
+    }
+    
+    size_t numBytes = fread(&frame.src[0], 1, frame.src.size(), input);
+    
+    if(numBytes != frame.src.size()){
+        if(numBytes > 0) ofLogWarning() << "Dropping truncated frame at the end of the bezier warp batch input";
+        return false;
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpBatch::writeHeader(){
+    
+    if(inputFormat != OFX_BEZIER_WARP_BATCH_Y4M) return true;
+    
+    // same stream parameters with the new size
+    string line = "YUV4MPEG2";
+    for(size_t i = 0; i < y4mParams.size(); i++){
+        const string & param = y4mParams[i];
+        if(param[0] == 'W'){
+            line += " W" + ofToString(dstWidth);
+        }else if(param[0] == 'H'){
+            line += " H" + ofToString(dstHeight);
+        }else{
+            line += " " + param;
+        }
+    }
+    line += "\n";
+    
+    return fwrite(line.c_str(), 1, line.size(), output) == line.size();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpBatch::writeFrame(Frame & frame){
+    
+    if(inputFormat == OFX_BEZIER_WARP_BATCH_Y4M){
+        if(fwrite("FRAME\n", 1, 6, output) != 6) return false;
+    }
+    
+    return fwrite(&frame.dst[0], 1, frame.dst.size(), output) == frame.dst.size();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::Queue::push(Frame * frame){
+    mutex.lock();
+    frames.push_back(frame);
+    mutex.unlock();
+    condition.signal();
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpBatch::Frame * ofxBezierWarpBatch::Queue::pop(){
+    mutex.lock();
+    while(frames.empty()) condition.wait(mutex);
+    Frame * frame = frames.front();
+    frames.pop_front();
+    mutex.unlock();
+    return frame;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpBatch::Stage::Stage(ofxBezierWarpBatch * batch, bool bReader){
+    this->batch = batch;
+    this->bReader = bReader;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpBatch::Stage::threadedFunction(){
+    if(bReader){
+        batch->readFrames();
+    }else{
+        batch->writeFrames();
+    }
+}
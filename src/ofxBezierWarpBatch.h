@@ -0,0 +1,168 @@
+/*
+ * ofxBezierWarpBatch.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPBATCH
+#define _H_OFXBEZIERWARPBATCH
+
+#include <cstdio>
+#include <deque>
+#include "ofThread.h"
+#include "Poco/Condition.h"
+#include "ofxBezierWarpRemap.h"
+
+enum ofxBezierWarpBatchFormat {
+    OFX_BEZIER_WARP_BATCH_GRAY = 0,     // raw 8 bit frames with 1, 3 or 4 bytes per pixel
+    OFX_BEZIER_WARP_BATCH_RGB,
+    OFX_BEZIER_WARP_BATCH_RGBA,
+    OFX_BEZIER_WARP_BATCH_I420,         // raw 4:2:0 frames laid out like ofxBezierWarpYUVFormat
+    OFX_BEZIER_WARP_BATCH_NV12,
+    OFX_BEZIER_WARP_BATCH_P010,
+    OFX_BEZIER_WARP_BATCH_Y4M           // YUV4MPEG2 (4:2:0 or mono) - size comes from its header
+};
+
+// streams a file of video frames through the CPU warp for offline
+// rendering. One thread reads frames, the calling thread remaps them
+// (each frame split across the remap's thread pool) and another thread
+// writes them out in the same format. Only getQueueSize() frames exist,
+// handed round the three stages, so whichever stage is slowest holds the
+// others up rather than frames piling up in memory
+
+class ofxBezierWarpBatch {
+    
+public:
+	
+    struct Stats {
+        int numFrames;
+        double seconds;
+        double fps;
+        // time each stage spent working rather than waiting on the others
+        double readSeconds;
+        double remapSeconds;
+        double writeSeconds;
+    };
+    
+    ofxBezierWarpBatch();
+    ~ofxBezierWarpBatch();
+    
+    // raw files have no header so they need their frame size - y4m doesn't
+    void setInput(ofxBezierWarpBatchFormat format, int width = 0, int height = 0);
+    ofxBezierWarpBatchFormat getInputFormat();
+    
+    // 0 keeps the input size
+    void setOutputSize(int width, int height);
+    
+    // frames in flight between the stages (at least 3 keeps them all busy)
+    void setQueueSize(int numFrames);
+    int getQueueSize();
+    
+    // 0 does the whole file
+    void setMaxFrames(int numFrames);
+    
+    ofxBezierWarpRemap& getRemap();
+    
+    // blocks until the input runs out - "-" reads stdin or writes stdout
+    bool process(ofxBezierWarp & warp, string inputPath, string outputPath);
+    
+    const Stats& getStats();
+    string getStatsString();
+    
+    static int getFrameSize(ofxBezierWarpBatchFormat format, int width, int height);
+    
+protected:
+	
+    struct Frame {
+        vector<unsigned char> src;
+        vector<unsigned char> dst;
+        bool bLast;
+    };
+    
+    // blocks on pop() until there's something in it
+    class Queue {
+    public:
+        void push(Frame * frame);
+        Frame * pop();
+        deque<Frame*> frames;
+        ofMutex mutex;
+        Poco::Condition condition;
+    };
+    
+    class Stage : public ofThread {
+    public:
+        Stage(ofxBezierWarpBatch * batch, bool bReader);
+        void threadedFunction();
+        ofxBezierWarpBatch * batch;
+        bool bReader;
+    };
+    
+    void readFrames();
+    void writeFrames();
+    void remapFrame(ofxBezierWarp & warp, Frame & frame);
+    
+    bool open(string inputPath, string outputPath);
+    void close();
+    
+    bool readHeader();
+    bool readFrame(Frame & frame);
+    bool writeHeader();
+    bool writeFrame(Frame & frame);
+    
+    ofxBezierWarpRemap remap;
+    
+    ofxBezierWarpBatchFormat inputFormat;
+    ofxBezierWarpBatchFormat format;    // what the frames actually hold (y4m is I420 or GRAY)
+    int inputWidth;
+    int inputHeight;
+    int outputWidth;
+    int outputHeight;
+    int dstWidth;       // what the frames actually get written at (the input size if no output size was set)
+    int dstHeight;
+    int queueSize;
+    int maxFrames;
+    
+    FILE * input;
+    FILE * output;
+    vector<string> y4mParams;
+    
+    Queue freeQueue;
+    Queue readQueue;
+    Queue writeQueue;
+    
+    volatile bool bError;
+    unsigned long long readMicros;
+    unsigned long long writeMicros;
+    
+    Stats stats;
+    
+};
+
+#endif
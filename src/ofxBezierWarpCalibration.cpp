@@ -0,0 +1,350 @@
+/*
+ * ofxBezierWarpCalibration.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpCalibration.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpCalibration::ofxBezierWarpCalibration(){
+    numXPoints = 0;
+    numYPoints = 0;
+    mode = OFX_BEZIER_WARP_BEZIER;
+    smoothness = 0.0f;
+    bFactorized = false;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpCalibration::~ofxBezierWarpCalibration(){
+    
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::setup(int _numXPoints, int _numYPoints, ofxBezierWarpMode _mode){
+    
+    if(_numXPoints < 2 || _numYPoints < 2){
+        ofLogError() << "Can't calibrate a warp with less than 2 X or Y grid points";
+        return;
+    }
+    
+    numXPoints = _numXPoints;
+    numYPoints = _numYPoints;
+    mode = _mode;
+    
+    cntrlPoints.assign(numXPoints * numYPoints * 3, 0.0f);
+    
+    buildSmoothness();
+    clear();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::setup(ofxBezierWarp & warp){
+    setup(warp.getNumXPoints(), warp.getNumYPoints(), warp.getWarpMode());
+    cntrlPoints = warp.getControlPointsReference();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::setSmoothness(float _smoothness){
+    _smoothness = MAX(_smoothness, 0.0f);
+    if(_smoothness != smoothness) bFactorized = false;
+    smoothness = _smoothness;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpCalibration::getSmoothness(){
+    return smoothness;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::addCorrespondence(ofPoint uv, ofPoint position, float weight){
+    
+    int n = numXPoints * numYPoints;
+    if(n == 0 || weight <= 0.0f) return;
+    
+    design.resize(design.size() + n);
+    float * row = &design[design.size() - n];
+    getRow(uv.x, uv.y, row);
+    
+    positions.push_back(position.x);
+    positions.push_back(position.y);
+    weights.push_back(weight);
+    
+    // only the points under this uv have weights - at most 4 x 4 of
+    // them with the patch modes so skip everything else
+    vector<int> nonZero;
+    for(int p = 0; p < n; p++){
+        if(row[p] != 0.0f) nonZero.push_back(p);
+    }
+    
+    for(size_t a = 0; a < nonZero.size(); a++){
+        int p = nonZero[a];
+        double wp = (double)weight * row[p];
+        rhsX[p] += wp * position.x;
+        rhsY[p] += wp * position.y;
+        for(size_t b = 0; b < nonZero.size(); b++){
+            int q = nonZero[b];
+            normal[p * n + q] += wp * row[q];
+        }
+    }
+    
+    // a rank one update keeps the factorization current without redoing it
+    if(bFactorized){
+        vector<double> scaled(n);
+        double s = sqrt((double)weight);
+        for(int p = 0; p < n; p++) scaled[p] = s * row[p];
+        updateFactor(&scaled[0]);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::addCorrespondences(const vector<ofPoint> & uvs, const vector<ofPoint> & _positions){
+    int count = MIN(uvs.size(), _positions.size());
+    for(int i = 0; i < count; i++) addCorrespondence(uvs[i], _positions[i]);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::clear(){
+    int n = numXPoints * numYPoints;
+    design.clear();
+    positions.clear();
+    weights.clear();
+    normal.assign(n * n, 0.0);
+    rhsX.assign(n, 0.0);
+    rhsY.assign(n, 0.0);
+    factor.clear();
+    bFactorized = false;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpCalibration::getNumCorrespondences(){
+    return weights.size();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpCalibration::getNumXPoints(){
+    return numXPoints;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpCalibration::getNumYPoints(){
+    return numYPoints;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpCalibration::solve(){
+    
+    int n = numXPoints * numYPoints;
+    if(n == 0) return false;
+    
+    if(!bFactorized && !factorize()){
+        ofLogError() << "Not enough correspondences to calibrate the warp (" << getNumCorrespondences() << " for "
+                     << numXPoints << " x " << numYPoints << " points) - add more or some smoothness";
+        return false;
+    }
+    
+    // L y = b then L^T x = y, for x and y together
+    vector<double> x(rhsX), y(rhsY);
+    
+    for(int i = 0; i < n; i++){
+        const double * l = &factor[i * n];
+        for(int k = 0; k < i; k++){
+            x[i] -= l[k] * x[k];
+            y[i] -= l[k] * y[k];
+        }
+        x[i] /= l[i];
+        y[i] /= l[i];
+    }
+    
+    for(int i = n - 1; i >= 0; i--){
+        for(int k = i + 1; k < n; k++){
+            double l = factor[k * n + i];
+            x[i] -= l * x[k];
+            y[i] -= l * y[k];
+        }
+        x[i] /= factor[i * n + i];
+        y[i] /= factor[i * n + i];
+    }
+    
+    cntrlPoints.resize(n * 3);
+    for(int p = 0; p < n; p++){
+        cntrlPoints[p*3+0] = x[p];
+        cntrlPoints[p*3+1] = y[p];
+        cntrlPoints[p*3+2] = 0.0f;
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+vector<GLfloat>& ofxBezierWarpCalibration::getControlPointsReference(){
+    return cntrlPoints;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::applyToWarp(ofxBezierWarp & warp){
+    if(cntrlPoints.size() != (size_t)(numXPoints * numYPoints * 3)) return;
+    if(warp.getNumXPoints() != numXPoints || warp.getNumYPoints() != numYPoints){
+        warp.setWarpGrid(numXPoints, numYPoints);
+    }
+    warp.setWarpMode(mode);
+    warp.setControlPoints(cntrlPoints);
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpCalibration::getError(){
+    
+    int n = numXPoints * numYPoints;
+    int count = getNumCorrespondences();
+    if(count == 0 || cntrlPoints.size() != (size_t)(n * 3)) return 0.0f;
+    
+    double sum = 0.0;
+    for(int k = 0; k < count; k++){
+        const float * row = &design[k * n];
+        double x = 0.0, y = 0.0;
+        for(int p = 0; p < n; p++){
+            x += row[p] * cntrlPoints[p*3+0];
+            y += row[p] * cntrlPoints[p*3+1];
+        }
+        x -= positions[k*2+0];
+        y -= positions[k*2+1];
+        sum += x * x + y * y;
+    }
+    
+    return sqrt(sum / count);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::getRow(float u, float v, float * row){
+    
+    int n = numXPoints * numYPoints;
+    for(int p = 0; p < n; p++) row[p] = 0.0f;
+    
+    int spanX = ofxBezierWarpBasisTable::getBasisSpan(mode, numXPoints);
+    int spanY = ofxBezierWarpBasisTable::getBasisSpan(mode, numYPoints);
+    
+    vector<float> wu(spanX), wv(spanY);
+    int firstX = ofxBezierWarpBasisTable::getBasisWeights(mode, numXPoints, ofClamp(u, 0, 1), &wu[0]);
+    int firstY = ofxBezierWarpBasisTable::getBasisWeights(mode, numYPoints, ofClamp(v, 0, 1), &wv[0]);
+    
+    for(int l = 0; l < spanY; l++){
+        for(int k = 0; k < spanX; k++){
+            row[(firstY + l) * numXPoints + firstX + k] = wu[k] * wv[l];
+        }
+    }
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpCalibration::factorize(){
+    
+    int n = numXPoints * numYPoints;
+    
+    factor.assign(n * n, 0.0);
+    
+    double maxDiagonal = 0.0;
+    for(int i = 0; i < n; i++){
+        maxDiagonal = MAX(maxDiagonal, normal[i * n + i] + smoothness * smooth[i * n + i]);
+    }
+    if(maxDiagonal <= 0.0) return false;
+    
+    // plain cholesky on the lower triangle
+    for(int j = 0; j < n; j++){
+        
+        double d = normal[j * n + j] + smoothness * smooth[j * n + j];
+        for(int k = 0; k < j; k++) d -= factor[j * n + k] * factor[j * n + k];
+        
+        // anything this small means a control point nothing depends on
+        if(d <= maxDiagonal * 1e-10) return false;
+        
+        double l = sqrt(d);
+        factor[j * n + j] = l;
+        
+        for(int i = j + 1; i < n; i++){
+            double s = normal[i * n + j] + smoothness * smooth[i * n + j];
+            for(int k = 0; k < j; k++) s -= factor[i * n + k] * factor[j * n + k];
+            factor[i * n + j] = s / l;
+        }
+    }
+    
+    bFactorized = true;
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::updateFactor(const double * row){
+    
+    // L L^T + x x^T in O(n^2) - zeros in x leave their column alone
+    int n = numXPoints * numYPoints;
+    vector<double> x(row, row + n);
+    
+    for(int k = 0; k < n; k++){
+        
+        if(x[k] == 0.0) continue;
+        
+        double lkk = factor[k * n + k];
+        double r = sqrt(lkk * lkk + x[k] * x[k]);
+        double c = r / lkk;
+        double s = x[k] / lkk;
+        factor[k * n + k] = r;
+        
+        for(int i = k + 1; i < n; i++){
+            double lik = (factor[i * n + k] + s * x[i]) / c;
+            x[i] = c * x[i] - s * lik;
+            factor[i * n + k] = lik;
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpCalibration::buildSmoothness(){
+    
+    // D^T D for every 1 -2 1 run of three points along a row or a column
+    int n = numXPoints * numYPoints;
+    smooth.assign(n * n, 0.0);
+    
+    for(int dir = 0; dir < 2; dir++){
+        int numAlong = dir == 0 ? numXPoints : numYPoints;
+        int numAcross = dir == 0 ? numYPoints : numXPoints;
+        for(int a = 0; a < numAcross; a++){
+            for(int b = 1; b < numAlong - 1; b++){
+                int p[3];
+                for(int k = 0; k < 3; k++){
+                    p[k] = dir == 0 ? a * numXPoints + b - 1 + k : (b - 1 + k) * numXPoints + a;
+                }
+                const double coef[3] = {1.0, -2.0, 1.0};
+                for(int i = 0; i < 3; i++){
+                    for(int j = 0; j < 3; j++){
+                        smooth[p[i] * n + p[j]] += coef[i] * coef[j];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * ofxBezierWarpCalibration.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPCALIBRATION
+#define _H_OFXBEZIERWARPCALIBRATION
+
+#include "ofxBezierWarp.h"
+
+// fits the control net to observed correspondences (eg., from a camera
+// looking at the projection): where a source position (normalized uv)
+// was seen in the output (warp pixels). The surface is linear in the
+// control points so this is a least squares fit - the basis weights for
+// each correspondence are worked out once when it's added, the normal
+// equations are cholesky factorized once and new correspondences update
+// that factorization in place, so refitting is two triangular solves
+//
+// smoothness penalises the second differences of the net along both
+// directions, which keeps parts of the net with few points under them
+// well behaved (and lets the fit work with fewer points than unknowns)
+
+class ofxBezierWarpCalibration {
+    
+public:
+	
+    ofxBezierWarpCalibration();
+    ~ofxBezierWarpCalibration();
+    
+    // the net to fit - changing it throws away the correspondences
+    void setup(int numXPoints, int numYPoints, ofxBezierWarpMode mode = OFX_BEZIER_WARP_BEZIER);
+    void setup(ofxBezierWarp & warp);
+    
+    // weight of the smoothness term against a single correspondence - 0 is a plain fit
+    void setSmoothness(float smoothness);
+    float getSmoothness();
+    
+    void addCorrespondence(ofPoint uv, ofPoint position, float weight = 1.0f);
+    void addCorrespondences(const vector<ofPoint> & uvs, const vector<ofPoint> & positions);
+    void clear();
+    
+    int getNumCorrespondences();
+    int getNumXPoints();
+    int getNumYPoints();
+    
+    // false if the correspondences don't pin the net down (too few of them
+    // or all bunched up with no smoothness to fill in the rest)
+    bool solve();
+    
+    // xyz like the warp's - z is always 0
+    vector<GLfloat>& getControlPointsReference();
+    void applyToWarp(ofxBezierWarp & warp);
+    
+    // root mean square distance (in warp pixels) between the fitted
+    // surface and the correspondences
+    float getError();
+    
+protected:
+	
+    void getRow(float u, float v, float * row);
+    bool factorize();
+    void updateFactor(const double * row);
+    void buildSmoothness();
+    
+    int numXPoints;
+    int numYPoints;
+    ofxBezierWarpMode mode;
+    float smoothness;
+    
+    // one dense row of basis weights per correspondence
+    vector<float> design;
+    vector<float> positions;
+    vector<float> weights;
+    
+    // normal equations without the smoothness, which is added when factorizing
+    vector<double> normal;
+    vector<double> smooth;
+    vector<double> rhsX;
+    vector<double> rhsY;
+    
+    // lower triangular cholesky factor of normal + smoothness * smooth
+    vector<double> factor;
+    bool bFactorized;
+    
+    vector<GLfloat> cntrlPoints;
+    
+private:
+	
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * ofxBezierWarpChannel.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpChannel.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//--------------------------------------------------------------
+ofxBezierWarpChannel::ofxBezierWarpChannel(){
+    working.version = 0;
+    working.fields = 0;
+    working.numXPoints = 0;
+    working.numYPoints = 0;
+    working.bDoWarp = true;
+    working.warpX = working.warpY = 0;
+    working.warpWidth = working.warpHeight = 0;
+    for(int i = 0; i < 3; i++) copy(working, slots[i]);
+    front = 0;
+    middle = 1;
+    back = 2;
+    numPublished = 0;
+    appliedVersion = 0;
+    numCoalesced = 0;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpChannel::~ofxBezierWarpChannel(){
+    working.cntrlPoints.clear();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpChannel::setControlPoints(const vector<GLfloat>& cntrlPoints, int numXPoints, int numYPoints){
+    
+    if(numXPoints < 2 || numYPoints < 2 || cntrlPoints.size() < (size_t)(numXPoints * numYPoints * 3)){
+        ofLogError() << "Control points don't match a " << numXPoints << " x " << numYPoints << " grid";
+        return;
+    }
+    
+    working.cntrlPoints.assign(cntrlPoints.begin(), cntrlPoints.begin() + numXPoints * numYPoints * 3);
+    working.numXPoints = numXPoints;
+    working.numYPoints = numYPoints;
+    working.fields |= CONTROL_POINTS;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpChannel::setControlPoint(int index, float x, float y){
+    if(index < 0 || index >= working.numXPoints * working.numYPoints) return;
+    working.cntrlPoints[index * 3 + 0] = x;
+    working.cntrlPoints[index * 3 + 1] = y;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpChannel::setDoWarp(bool b){
+    working.bDoWarp = b;
+    working.fields |= DO_WARP;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpChannel::setOffset(ofPoint p){
+    working.offset = p;
+    working.fields |= OFFSET;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpChannel::setWarpGridPosition(float x, float y, float w, float h){
+    working.warpX = x;
+    working.warpY = y;
+    working.warpWidth = w;
+    working.warpHeight = h;
+    working.fields |= WARP_GRID_POSITION;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBezierWarpChannel::publish(){
+    
+    // the back slot is only ever touched from this thread so it can be
+    // filled in at leisure, then it becomes the middle (marked fresh) and
+    // whatever was in the middle - picked up or not - is the new back
+    working.version = ++numPublished;
+    copy(working, slots[back]);
+    
+    back = exchange(&middle, back | FRESH) & ~FRESH;
+    
+    return working.version;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBezierWarpChannel::getNumPublished(){
+    return numPublished;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpChannel::apply(ofxBezierWarp & warp){
+    
+    // only this thread clears FRESH so if it isn't set there's nothing
+    // to do, and if it is the exchange can't lose it
+    if((middle & FRESH) == 0) return false;
+    
+    front = exchange(&middle, front) & ~FRESH;
+    
+    const Snapshot & snapshot = slots[front];
+    
+    if(snapshot.version <= appliedVersion) return false;
+    
+    numCoalesced += snapshot.version - appliedVersion - 1;
+    appliedVersion = snapshot.version;
+    
+    if(snapshot.fields & CONTROL_POINTS){
+        if(warp.getNumXPoints() != snapshot.numXPoints || warp.getNumYPoints() != snapshot.numYPoints){
+            warp.setWarpGrid(snapshot.numXPoints, snapshot.numYPoints);
+        }
+        // same size so this is just a copy
+        warp.getControlPointsReference().assign(snapshot.cntrlPoints.begin(), snapshot.cntrlPoints.end());
+    }
+    
+    if(snapshot.fields & DO_WARP) warp.setDoWarp(snapshot.bDoWarp);
+    if(snapshot.fields & OFFSET) warp.setOffset(snapshot.offset);
+    
+    if(snapshot.fields & WARP_GRID_POSITION){
+        warp.setWarpGridPosition(snapshot.warpX, snapshot.warpY, snapshot.warpWidth, snapshot.warpHeight);
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBezierWarpChannel::getAppliedVersion(){
+    return appliedVersion;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBezierWarpChannel::getNumCoalesced(){
+    return numCoalesced;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpChannel::copy(const Snapshot & src, Snapshot & dst){
+    dst.version = src.version;
+    dst.fields = src.fields;
+    // assign() reuses what's there when the size hasn't changed
+    dst.cntrlPoints.assign(src.cntrlPoints.begin(), src.cntrlPoints.end());
+    dst.numXPoints = src.numXPoints;
+    dst.numYPoints = src.numYPoints;
+    dst.bDoWarp = src.bDoWarp;
+    dst.offset = src.offset;
+    dst.warpX = src.warpX;
+    dst.warpY = src.warpY;
+    dst.warpWidth = src.warpWidth;
+    dst.warpHeight = src.warpHeight;
+}
+
+//--------------------------------------------------------------
+long ofxBezierWarpChannel::exchange(volatile long * target, long value){
+    // needs to be a full barrier both ways: the slot has to be written
+    // before the index goes out and read after the index comes in
+#ifdef _MSC_VER
+    return _InterlockedExchange(target, value);
+#else
+    long old = *target;
+    while(true){
+        long seen = __sync_val_compare_and_swap(target, old, value);
+        if(seen == old) return old;
+        old = seen;
+    }
+#endif
+}
@@ -0,0 +1,122 @@
+/*
+ * ofxBezierWarpChannel.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPCHANNEL
+#define _H_OFXBEZIERWARPCHANNEL
+
+#include "ofxBezierWarp.h"
+
+// hands warp settings over from a control thread (eg., OSC or the network)
+// to the thread that draws without either one ever waiting on the other.
+// It's a triple buffer: the control thread fills in its own snapshot and
+// publish() swaps it into the middle slot, then apply() on the render
+// thread swaps the middle slot out if there's something newer in it. A
+// burst of updates between two frames is only applied once (the newest)
+// and once the slots have grown to the size of the net nothing allocates
+//
+// one thread calls the set*()'s and publish(), one other calls apply()
+
+class ofxBezierWarpChannel {
+    
+public:
+	
+    ofxBezierWarpChannel();
+    ~ofxBezierWarpChannel();
+    
+    // control thread - nothing reaches the warp until publish(), and
+    // only what has been set at some point is ever applied
+    void setControlPoints(const vector<GLfloat>& cntrlPoints, int numXPoints, int numYPoints);
+    void setControlPoint(int index, float x, float y);
+    void setDoWarp(bool b);
+    void setOffset(ofPoint p);
+    void setWarpGridPosition(float x, float y, float w, float h);
+    
+    // returns the new snapshot's version
+    unsigned int publish();
+    unsigned int getNumPublished();
+    
+    // render thread, once a frame - true if a newer snapshot was applied.
+    // Changing the net size goes through setWarpGrid() which allocates
+    bool apply(ofxBezierWarp & warp);
+    
+    // version of the last snapshot applied and how many were published
+    // but skipped over because a newer one came in before the next frame
+    unsigned int getAppliedVersion();
+    unsigned int getNumCoalesced();
+    
+protected:
+	
+    enum {
+        CONTROL_POINTS = 1,
+        DO_WARP = 2,
+        OFFSET = 4,
+        WARP_GRID_POSITION = 8
+    };
+    
+    struct Snapshot {
+        unsigned int version;
+        unsigned int fields;
+        vector<GLfloat> cntrlPoints;
+        int numXPoints;
+        int numYPoints;
+        bool bDoWarp;
+        ofPoint offset;
+        float warpX;
+        float warpY;
+        float warpWidth;
+        float warpHeight;
+    };
+    
+    static void copy(const Snapshot & src, Snapshot & dst);
+    static long exchange(volatile long * target, long value);
+    
+    // the control thread's snapshot, then the three that get swapped
+    // around - middle is the slot index with FRESH set when it hasn't
+    // been picked up yet
+    Snapshot working;
+    Snapshot slots[3];
+    
+    static const long FRESH = 4;
+    volatile long middle;
+    int back;
+    int front;
+    
+    unsigned int numPublished;
+    unsigned int appliedVersion;
+    unsigned int numCoalesced;
+    
+private:
+	
+};
+
+#endif
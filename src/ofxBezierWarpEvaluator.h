@@ -0,0 +1,281 @@
+/*
+ * ofxBezierWarpEvaluator.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPEVALUATOR
+#define _H_OFXBEZIERWARPEVALUATOR
+
+#include "ofGraphics.h"
+#include "ofxBezierWarpSIMD.h"
+
+// almost every warp is a single bezier surface of 2x2 (a bilinear
+// keystone), 3x3 or 4x4 control points so those sizes get their own
+// evaluators with the point counts fixed at compile time. Every loop has
+// a constant trip count (the compiler unrolls them completely) and the
+// binomials are folded into the net up front by converting it to the
+// power basis - after that a vertex is a few multiply-adds in v and u
+
+// bezier points p[0], p[stride]... -> a[] with p(t) = a0 + a1 t + a2 t^2 + a3 t^3
+template<int N>
+inline void ofxBezierWarpToPowerBasis(const float * p, int stride, float * a);
+
+template<>
+inline void ofxBezierWarpToPowerBasis<2>(const float * p, int stride, float * a){
+    a[0] = p[0];
+    a[1] = p[stride] - p[0];
+}
+
+template<>
+inline void ofxBezierWarpToPowerBasis<3>(const float * p, int stride, float * a){
+    float p0 = p[0], p1 = p[stride], p2 = p[stride * 2];
+    a[0] = p0;
+    a[1] = 2.0f * (p1 - p0);
+    a[2] = p0 - 2.0f * p1 + p2;
+}
+
+template<>
+inline void ofxBezierWarpToPowerBasis<4>(const float * p, int stride, float * a){
+    float p0 = p[0], p1 = p[stride], p2 = p[stride * 2], p3 = p[stride * 3];
+    a[0] = p0;
+    a[1] = 3.0f * (p1 - p0);
+    a[2] = 3.0f * (p0 - 2.0f * p1 + p2);
+    a[3] = p3 - p0 + 3.0f * (p1 - p2);
+}
+
+// bernstein weights with the binomials written out
+template<int N>
+inline void ofxBezierWarpBernstein(float t, float * w);
+
+template<>
+inline void ofxBezierWarpBernstein<2>(float t, float * w){
+    w[0] = 1.0f - t;
+    w[1] = t;
+}
+
+template<>
+inline void ofxBezierWarpBernstein<3>(float t, float * w){
+    float s = 1.0f - t;
+    w[0] = s * s;
+    w[1] = 2.0f * s * t;
+    w[2] = t * t;
+}
+
+template<>
+inline void ofxBezierWarpBernstein<4>(float t, float * w){
+    float s = 1.0f - t;
+    w[0] = s * s * s;
+    w[1] = 3.0f * s * s * t;
+    w[2] = 3.0f * s * t * t;
+    w[3] = t * t * t;
+}
+
+//--------------------------------------------------------------
+template<int NX, int NY>
+class ofxBezierWarpFixedSurface {
+    
+public:
+	
+    // control points as ofxBezierWarp keeps them (xyz, x fastest)
+    void setup(const GLfloat * cntrlPoints){
+        for(int c = 0; c < 3; c++){
+            // along v for every column of points, then along u for every power of v
+            float cols[NY][NX];
+            for(int k = 0; k < NX; k++){
+                float a[NY];
+                ofxBezierWarpToPowerBasis<NY>(cntrlPoints + k * 3 + c, NX * 3, a);
+                for(int m = 0; m < NY; m++) cols[m][k] = a[m];
+            }
+            for(int m = 0; m < NY; m++){
+                ofxBezierWarpToPowerBasis<NX>(cols[m], 1, coeffs[c][m]);
+            }
+        }
+    }
+    
+    // the polynomial in u for a row at v
+    inline void getRow(int c, float v, float * row) const{
+        for(int n = 0; n < NX; n++){
+            float r = coeffs[c][NY - 1][n];
+            for(int m = NY - 2; m >= 0; m--) r = r * v + coeffs[c][m][n];
+            row[n] = r;
+        }
+    }
+    
+    // multiply then add like the SIMD version so both give the same result
+    static inline float horner(const float * a, float t){
+        float r = a[NX - 1];
+        for(int n = NX - 2; n >= 0; n--){
+            float p = r * t;
+            r = p + a[n];
+        }
+        return r;
+    }
+    
+#if defined(OFX_BEZIER_WARP_SSE)
+    static inline __m128 horner(const float * a, __m128 t){
+        __m128 r = _mm_set1_ps(a[NX - 1]);
+        for(int n = NX - 2; n >= 0; n--){
+            r = _mm_add_ps(_mm_mul_ps(r, t), _mm_set1_ps(a[n]));
+        }
+        return r;
+    }
+#endif
+    
+    // rows [rowBegin, rowEnd) of a (gridDivX + 1) x (gridDivY + 1) grid of
+    // xyz vertices - with 2 components z is just zeroed
+    void evaluateGrid(int gridDivX, int gridDivY, int rowBegin, int rowEnd, GLfloat * vertices, int numComponents) const{
+        
+        int numCols = gridDivX + 1;
+        float invDivX = 1.0f / gridDivX;
+        
+        for(int j = rowBegin; j < rowEnd; j++){
+            
+            float v = (float)j / gridDivY;
+            GLfloat * vert = vertices + j * numCols * 3;
+            
+            float rx[NX], ry[NX], rz[NX];
+            getRow(0, v, rx);
+            getRow(1, v, ry);
+            if(numComponents == 3){
+                getRow(2, v, rz);
+            }else{
+                for(int n = 0; n < NX; n++) rz[n] = 0.0f;
+            }
+            
+            int i = 0;
+            
+#if defined(OFX_BEZIER_WARP_SSE)
+            // 4 vertices at a time transposed back to xyz - every store spills
+            // one float into the vertex after, which gets written over later
+            __m128 offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+            __m128 inv4 = _mm_set1_ps(invDivX);
+            for(; i + 4 < numCols; i += 4){
+                __m128 u = _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)i), offsets), inv4);
+                __m128 x = horner(rx, u);
+                __m128 y = horner(ry, u);
+                __m128 z = horner(rz, u);
+                __m128 w = _mm_setzero_ps();
+                _MM_TRANSPOSE4_PS(x, y, z, w);
+                _mm_storeu_ps(vert + i * 3, x);
+                _mm_storeu_ps(vert + i * 3 + 3, y);
+                _mm_storeu_ps(vert + i * 3 + 6, z);
+                _mm_storeu_ps(vert + i * 3 + 9, w);
+            }
+#endif
+            
+            for(; i < numCols; i++){
+                float u = (float)i * invDivX;
+                vert[i*3+0] = horner(rx, u);
+                vert[i*3+1] = horner(ry, u);
+                vert[i*3+2] = horner(rz, u);
+            }
+        }
+    }
+    
+    // coeffs[c][m][n] goes with v^m u^n
+    float coeffs[3][NY][NX];
+    
+};
+
+typedef void (*ofxBezierWarpGridEvaluator)(const GLfloat * cntrlPoints, int gridDivX, int gridDivY,
+                                           int rowBegin, int rowEnd, GLfloat * vertices, int numComponents);
+typedef void (*ofxBezierWarpPointEvaluator)(const GLfloat * cntrlPoints, float u, float v, GLfloat * out);
+
+//--------------------------------------------------------------
+template<int NX, int NY>
+void ofxBezierWarpEvaluateFixedGrid(const GLfloat * cntrlPoints, int gridDivX, int gridDivY,
+                                    int rowBegin, int rowEnd, GLfloat * vertices, int numComponents){
+    ofxBezierWarpFixedSurface<NX, NY> surface;
+    surface.setup(cntrlPoints);
+    surface.evaluateGrid(gridDivX, gridDivY, rowBegin, rowEnd, vertices, numComponents);
+}
+
+//--------------------------------------------------------------
+template<int NX, int NY>
+void ofxBezierWarpEvaluateFixedPoint(const GLfloat * cntrlPoints, float u, float v, GLfloat * out){
+    
+    // a single point doesn't pay for the basis change
+    float wu[NX], wv[NY];
+    ofxBezierWarpBernstein<NX>(u, wu);
+    ofxBezierWarpBernstein<NY>(v, wv);
+    
+    out[0] = out[1] = out[2] = 0.0f;
+    
+    for(int l = 0; l < NY; l++){
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        const GLfloat * p = cntrlPoints + l * NX * 3;
+        for(int k = 0; k < NX; k++){
+            x += wu[k] * p[k*3+0];
+            y += wu[k] * p[k*3+1];
+            z += wu[k] * p[k*3+2];
+        }
+        out[0] += wv[l] * x;
+        out[1] += wv[l] * y;
+        out[2] += wv[l] * z;
+    }
+}
+
+// NULL for anything that doesn't have a fixed size version (the caller
+// also has to check the mode - these are only for OFX_BEZIER_WARP_BEZIER)
+
+//--------------------------------------------------------------
+static inline ofxBezierWarpGridEvaluator ofxBezierWarpGetGridEvaluator(int numXPoints, int numYPoints){
+    switch(numYPoints * 8 + numXPoints){
+        case 2 * 8 + 2: return &ofxBezierWarpEvaluateFixedGrid<2, 2>;
+        case 2 * 8 + 3: return &ofxBezierWarpEvaluateFixedGrid<3, 2>;
+        case 2 * 8 + 4: return &ofxBezierWarpEvaluateFixedGrid<4, 2>;
+        case 3 * 8 + 2: return &ofxBezierWarpEvaluateFixedGrid<2, 3>;
+        case 3 * 8 + 3: return &ofxBezierWarpEvaluateFixedGrid<3, 3>;
+        case 3 * 8 + 4: return &ofxBezierWarpEvaluateFixedGrid<4, 3>;
+        case 4 * 8 + 2: return &ofxBezierWarpEvaluateFixedGrid<2, 4>;
+        case 4 * 8 + 3: return &ofxBezierWarpEvaluateFixedGrid<3, 4>;
+        case 4 * 8 + 4: return &ofxBezierWarpEvaluateFixedGrid<4, 4>;
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------------
+static inline ofxBezierWarpPointEvaluator ofxBezierWarpGetPointEvaluator(int numXPoints, int numYPoints){
+    switch(numYPoints * 8 + numXPoints){
+        case 2 * 8 + 2: return &ofxBezierWarpEvaluateFixedPoint<2, 2>;
+        case 2 * 8 + 3: return &ofxBezierWarpEvaluateFixedPoint<3, 2>;
+        case 2 * 8 + 4: return &ofxBezierWarpEvaluateFixedPoint<4, 2>;
+        case 3 * 8 + 2: return &ofxBezierWarpEvaluateFixedPoint<2, 3>;
+        case 3 * 8 + 3: return &ofxBezierWarpEvaluateFixedPoint<3, 3>;
+        case 3 * 8 + 4: return &ofxBezierWarpEvaluateFixedPoint<4, 3>;
+        case 4 * 8 + 2: return &ofxBezierWarpEvaluateFixedPoint<2, 4>;
+        case 4 * 8 + 3: return &ofxBezierWarpEvaluateFixedPoint<3, 4>;
+        case 4 * 8 + 4: return &ofxBezierWarpEvaluateFixedPoint<4, 4>;
+    }
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,374 @@
+/*
+ * ofxBezierWarpInverse.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpInverse.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpInverse::ofxBezierWarpInverse(){
+    builtMesh = NULL;
+    builtMeshVersion = 0;
+    numXPoints = 0;
+    numYPoints = 0;
+    mode = OFX_BEZIER_WARP_BEZIER;
+    originX = originY = 0.0f;
+    cellWidth = cellHeight = 1.0f;
+    numCellsX = numCellsY = 0;
+    numRefinements = 0;
+    numThreads = 0;
+    bPoolSetup = false;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpInverse::~ofxBezierWarpInverse(){
+    clear();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpInverse::update(ofxBezierWarpMesh & mesh){
+    
+    if(builtMesh == &mesh && builtMeshVersion == mesh.getVersion() && isAllocated()) return false;
+    
+    clear();
+    
+    if(!mesh.isAllocated()) return false;
+    
+    builtMesh = &mesh;
+    builtMeshVersion = mesh.getVersion();
+    
+    vertices = mesh.getVerticesReference();
+    texCoords = mesh.getTexCoordsReference();
+    indices = mesh.getIndicesReference();
+    cntrlPoints = mesh.getControlPointsReference();
+    lattice = mesh.getLatticeReference();
+    numXPoints = mesh.getNumXPoints();
+    numYPoints = mesh.getNumYPoints();
+    mode = mesh.getMode();
+    
+    int numTriangles = indices.size() / 3;
+    int numVertices = vertices.size() / 3;
+    if(numTriangles == 0 || numVertices == 0) return false;
+    
+    float minX = vertices[0], maxX = vertices[0];
+    float minY = vertices[1], maxY = vertices[1];
+    for(int i = 1; i < numVertices; i++){
+        minX = MIN(minX, vertices[i*3+0]); maxX = MAX(maxX, vertices[i*3+0]);
+        minY = MIN(minY, vertices[i*3+1]); maxY = MAX(maxY, vertices[i*3+1]);
+    }
+    
+    // about two triangles a cell, shaped like the mesh bounds
+    float w = MAX(maxX - minX, 1.0f);
+    float h = MAX(maxY - minY, 1.0f);
+    float numCells = MAX(numTriangles / 2, 1);
+    numCellsX = (int)ofClamp(ceil(sqrt(numCells * w / h)), 1, 1024);
+    numCellsY = (int)ofClamp(ceil(numCells / numCellsX), 1, 1024);
+    
+    originX = minX;
+    originY = minY;
+    cellWidth = w / numCellsX;
+    cellHeight = h / numCellsY;
+    
+    // count what lands in each cell then fill, so every cell is one run
+    // of triangle numbers in drawing order
+    cellStart.assign(numCellsX * numCellsY + 1, 0);
+    
+    for(int pass = 0; pass < 2; pass++){
+        
+        vector<int> cursor;
+        if(pass == 1){
+            for(int c = 0; c < numCellsX * numCellsY; c++) cellStart[c + 1] += cellStart[c];
+            cellTriangles.resize(cellStart.back());
+            cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        }
+        
+        for(int t = 0; t < numTriangles; t++){
+            
+            const GLfloat * a = &vertices[indices[t*3+0] * 3];
+            const GLfloat * b = &vertices[indices[t*3+1] * 3];
+            const GLfloat * c = &vertices[indices[t*3+2] * 3];
+            
+            int cx0 = ofClamp((int)((MIN(a[0], MIN(b[0], c[0])) - originX) / cellWidth), 0, numCellsX - 1);
+            int cx1 = ofClamp((int)((MAX(a[0], MAX(b[0], c[0])) - originX) / cellWidth), 0, numCellsX - 1);
+            int cy0 = ofClamp((int)((MIN(a[1], MIN(b[1], c[1])) - originY) / cellHeight), 0, numCellsY - 1);
+            int cy1 = ofClamp((int)((MAX(a[1], MAX(b[1], c[1])) - originY) / cellHeight), 0, numCellsY - 1);
+            
+            for(int cy = cy0; cy <= cy1; cy++){
+                for(int cx = cx0; cx <= cx1; cx++){
+                    int cell = cy * numCellsX + cx;
+                    if(pass == 0){
+                        cellStart[cell + 1]++;
+                    }else{
+                        cellTriangles[cursor[cell]++] = t;
+                    }
+                }
+            }
+        }
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpInverse::clear(){
+    builtMesh = NULL;
+    vertices.clear();
+    texCoords.clear();
+    indices.clear();
+    cntrlPoints.clear();
+    lattice = ofxBezierWarpLattice();
+    cellStart.clear();
+    cellTriangles.clear();
+    numCellsX = numCellsY = 0;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpInverse::isAllocated(){
+    return numCellsX > 0 && numCellsY > 0;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpInverse::setNumRefinements(int numIterations){
+    numRefinements = MAX(numIterations, 0);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpInverse::getNumRefinements(){
+    return numRefinements;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpInverse::setNumThreads(int _numThreads){
+    // 0 means one thread per core
+    numThreads = _numThreads;
+    bPoolSetup = false;
+    pool.close();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpInverse::getNumThreads(){
+    return pool.getNumThreads();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpInverse::setupPool(){
+    if(!bPoolSetup){
+        pool.setup(numThreads);
+        bPoolSetup = true;
+    }
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpInverse::getCell(float x, float y){
+    int cx = (int)floor((x - originX) / cellWidth);
+    int cy = (int)floor((y - originY) / cellHeight);
+    // points right on the far edge still belong to the last cell
+    if(cx == numCellsX && x <= originX + cellWidth * numCellsX) cx--;
+    if(cy == numCellsY && y <= originY + cellHeight * numCellsY) cy--;
+    if(cx < 0 || cy < 0 || cx >= numCellsX || cy >= numCellsY) return -1;
+    return cy * numCellsX + cx;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpInverse::find(float x, float y, float & u, float & v){
+    
+    if(!isAllocated()) return false;
+    
+    if(!findTriangle(x, y, u, v)) return false;
+    
+    if(numRefinements > 0) refine(x, y, u, v);
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpInverse::find(const ofPoint & p, ofPoint & uv){
+    float u, v;
+    if(!find(p.x, p.y, u, v)){
+        uv.set(-1, -1);
+        return false;
+    }
+    uv.set(u, v);
+    return true;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpInverse::find(const float * points, float * uvs, int numPoints){
+    
+    if(numPoints <= 0) return 0;
+    
+    FindJob job;
+    job.inverse = this;
+    job.points = points;
+    job.uvs = uvs;
+    job.numPoints = numPoints;
+    job.batchSize = 256;
+    job.numFound = 0;
+    
+    setupPool();
+    pool.run(job, (numPoints + job.batchSize - 1) / job.batchSize);
+    
+    return job.numFound;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpInverse::find(const vector<ofPoint> & points, vector<ofPoint> & uvs){
+    
+    // ofPoint is xyz so pack the xy pairs first
+    vector<float> xy(points.size() * 2);
+    for(size_t i = 0; i < points.size(); i++){
+        xy[i*2+0] = points[i].x;
+        xy[i*2+1] = points[i].y;
+    }
+    
+    vector<float> results(points.size() * 2);
+    int numFound = find(xy.size() ? &xy[0] : NULL, results.size() ? &results[0] : NULL, points.size());
+    
+    uvs.resize(points.size());
+    for(size_t i = 0; i < points.size(); i++){
+        uvs[i].set(results[i*2+0], results[i*2+1]);
+    }
+    
+    return numFound;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpInverse::findTriangle(float x, float y, float & u, float & v){
+    
+    int cell = getCell(x, y);
+    if(cell == -1) return false;
+    
+    // backwards so the last triangle drawn over a point is the one found
+    for(int k = cellStart[cell + 1] - 1; k >= cellStart[cell]; k--){
+        
+        int t = cellTriangles[k];
+        const GLuint * tri = &indices[t * 3];
+        const GLfloat * a = &vertices[tri[0] * 3];
+        const GLfloat * b = &vertices[tri[1] * 3];
+        const GLfloat * c = &vertices[tri[2] * 3];
+        
+        float abx = b[0] - a[0], aby = b[1] - a[1];
+        float acx = c[0] - a[0], acy = c[1] - a[1];
+        float apx = x - a[0], apy = y - a[1];
+        
+        float area = abx * acy - aby * acx;
+        if(area == 0.0f) continue;
+        
+        // a little slack so points on shared edges can't fall between triangles
+        float s = (apx * acy - apy * acx) / area;
+        float r = (abx * apy - aby * apx) / area;
+        const float eps = 1e-5f;
+        if(s < -eps || r < -eps || s + r > 1.0f + eps) continue;
+        
+        const GLfloat * ta = &texCoords[tri[0] * 2];
+        const GLfloat * tb = &texCoords[tri[1] * 2];
+        const GLfloat * tc = &texCoords[tri[2] * 2];
+        
+        u = ta[0] + s * (tb[0] - ta[0]) + r * (tc[0] - ta[0]);
+        v = ta[1] + s * (tb[1] - ta[1]) + r * (tc[1] - ta[1]);
+        
+        return true;
+    }
+    
+    return false;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpInverse::refine(float x, float y, float & u, float & v){
+    
+    // newton on surface(u, v) - (x, y) with a finite difference jacobian,
+    // starting from the triangle's answer. Folds can send it off somewhere
+    // else so only keep steps that get closer
+    
+    const float h = 0.0005f;
+    
+    GLfloat p[3], pu[3], pv[3];
+    ofxBezierWarpMesh::evaluate(cntrlPoints, numXPoints, numYPoints, u, v, p, mode);
+    lattice.addDisplacement(u, v, p);
+    float ex = p[0] - x;
+    float ey = p[1] - y;
+    float error = ex * ex + ey * ey;
+    
+    for(int i = 0; i < numRefinements && error > 1e-6f; i++){
+        
+        float hu = u + h <= 1.0f ? h : -h;
+        float hv = v + h <= 1.0f ? h : -h;
+        ofxBezierWarpMesh::evaluate(cntrlPoints, numXPoints, numYPoints, u + hu, v, pu, mode);
+        ofxBezierWarpMesh::evaluate(cntrlPoints, numXPoints, numYPoints, u, v + hv, pv, mode);
+        lattice.addDisplacement(u + hu, v, pu);
+        lattice.addDisplacement(u, v + hv, pv);
+        
+        float dxu = (pu[0] - p[0]) / hu, dyu = (pu[1] - p[1]) / hu;
+        float dxv = (pv[0] - p[0]) / hv, dyv = (pv[1] - p[1]) / hv;
+        float det = dxu * dyv - dxv * dyu;
+        if(fabs(det) < 1e-12f) break;
+        
+        float nu = ofClamp(u - (dyv * ex - dxv * ey) / det, 0.0f, 1.0f);
+        float nv = ofClamp(v - (dxu * ey - dyu * ex) / det, 0.0f, 1.0f);
+        
+        ofxBezierWarpMesh::evaluate(cntrlPoints, numXPoints, numYPoints, nu, nv, p, mode);
+        lattice.addDisplacement(nu, nv, p);
+        float nex = p[0] - x;
+        float ney = p[1] - y;
+        float nerror = nex * nex + ney * ney;
+        if(nerror >= error) break;
+        
+        u = nu;
+        v = nv;
+        ex = nex;
+        ey = ney;
+        error = nerror;
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpInverse::FindJob::process(int batch){
+    
+    int begin = batch * batchSize;
+    int end = MIN(begin + batchSize, numPoints);
+    int found = 0;
+    
+    for(int i = begin; i < end; i++){
+        float u, v;
+        if(inverse->find(points[i*2+0], points[i*2+1], u, v)){
+            uvs[i*2+0] = u;
+            uvs[i*2+1] = v;
+            found++;
+        }else{
+            uvs[i*2+0] = -1.0f;
+            uvs[i*2+1] = -1.0f;
+        }
+    }
+    
+    mutex.lock();
+    numFound += found;
+    mutex.unlock();
+}
@@ -0,0 +1,130 @@
+/*
+ * ofxBezierWarpInverse.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPINVERSE
+#define _H_OFXBEZIERWARPINVERSE
+
+#include "ofxBezierWarpMesh.h"
+#include "ofxBezierWarpThreadPool.h"
+
+// the warp run backwards: which source position shows up at a point of
+// the output (eg., touches on a warped surface, overlays, inverse LUTs).
+// The mesh triangles are bucketed into a uniform grid so a query only
+// tests the few triangles in its cell - where the warp folds over itself
+// the last triangle drawn wins, same as on screen. Optional newton steps
+// then move the answer off the flat triangles onto the real surface
+//
+// points are in the mesh's space (the warp's width x height) and answers
+// are normalized source coords like the mesh texcoords
+
+class ofxBezierWarpInverse {
+    
+public:
+	
+    ofxBezierWarpInverse();
+    ~ofxBezierWarpInverse();
+    
+    // rebuilds the triangle grid if the mesh changed - returns true if it did
+    bool update(ofxBezierWarpMesh & mesh);
+    void clear();
+    bool isAllocated();
+    
+    // 0 gives exactly what the mesh draws (and what the remap tables hold)
+    void setNumRefinements(int numIterations);
+    int getNumRefinements();
+    
+    void setNumThreads(int numThreads);
+    int getNumThreads();
+    
+    // false if none of the warp is drawn at x, y
+    bool find(float x, float y, float & u, float & v);
+    bool find(const ofPoint & p, ofPoint & uv);
+    
+    // numPoints xy pairs in, uv pairs out (-1 where nothing is drawn) split
+    // across the thread pool - returns how many were found
+    int find(const float * points, float * uvs, int numPoints);
+    int find(const vector<ofPoint> & points, vector<ofPoint> & uvs);
+    
+protected:
+	
+    void setupPool();
+    int getCell(float x, float y);
+    bool findTriangle(float x, float y, float & u, float & v);
+    void refine(float x, float y, float & u, float & v);
+    
+    class FindJob : public ofxBezierWarpJob {
+    public:
+        void process(int batch);
+        ofxBezierWarpInverse * inverse;
+        const float * points;
+        float * uvs;
+        int numPoints;
+        int batchSize;
+        int numFound;
+        ofMutex mutex;
+    };
+    
+    ofxBezierWarpMesh * builtMesh;
+    unsigned int builtMeshVersion;
+    
+    // copies of what the mesh was built from for the triangle tests and newton steps
+    vector<GLfloat> vertices;
+    vector<GLfloat> texCoords;
+    vector<GLuint> indices;
+    vector<GLfloat> cntrlPoints;
+    ofxBezierWarpLattice lattice;
+    int numXPoints;
+    int numYPoints;
+    ofxBezierWarpMode mode;
+    
+    // triangles in each cell (ascending) are cellTriangles[cellStart[c], cellStart[c + 1])
+    vector<int> cellStart;
+    vector<int> cellTriangles;
+    float originX;
+    float originY;
+    float cellWidth;
+    float cellHeight;
+    int numCellsX;
+    int numCellsY;
+    
+    int numRefinements;
+    
+    ofxBezierWarpThreadPool pool;
+    int numThreads;
+    bool bPoolSetup;
+    
+private:
+	
+};
+
+#endif
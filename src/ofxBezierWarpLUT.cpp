@@ -0,0 +1,757 @@
+/*
+ * ofxBezierWarpLUT.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpLUT.h"
+#include "ofxBezierWarpRasterizer.h"
+
+static const char lutMagic[8] = {'O', 'F', 'X', 'B', 'W', 'L', 'U', 'T'};
+static const unsigned int lutFileVersion = 5;
+
+//--------------------------------------------------------------
+static unsigned long long hashBytes(unsigned long long hash, const void * data, size_t size){
+    // 64 bit FNV-1a
+    const unsigned char * bytes = (const unsigned char *)data;
+    for(size_t i = 0; i < size; i++){
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//--------------------------------------------------------------
+template <typename T>
+static unsigned long long hashVector(unsigned long long hash, const vector<T> & data){
+    return data.size() > 0 ? hashBytes(hash, &data[0], data.size() * sizeof(T)) : hash;
+}
+
+//--------------------------------------------------------------
+static unsigned long long makeChecksum(const unsigned int * header, unsigned long long key, const unsigned int * sizes,
+                                       const vector<float> & coords, const vector<unsigned short> & fixedCoords,
+                                       const vector<ofxBezierWarpLUT::Tile> & tiles, const vector<signed char> & residuals,
+                                       const vector<int> & raw){
+    unsigned long long hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, header, 8 * sizeof(unsigned int));
+    hash = hashBytes(hash, &key, sizeof(key));
+    hash = hashBytes(hash, sizes, 5 * sizeof(unsigned int));
+    hash = hashVector(hash, coords);
+    hash = hashVector(hash, fixedCoords);
+    hash = hashVector(hash, tiles);
+    hash = hashVector(hash, residuals);
+    hash = hashVector(hash, raw);
+    return hash;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLUT::ofxBezierWarpLUT(){
+    width = 0;
+    height = 0;
+    srcWidth = 0;
+    srcHeight = 0;
+    key = 0;
+    format = OFX_BEZIER_WARP_LUT_FLOAT;
+    fractionBits = 0;
+    numTilesX = 0;
+    numTilesY = 0;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLUT::~ofxBezierWarpLUT(){
+    clear();
+}
+
+//--------------------------------------------------------------
+unsigned long long ofxBezierWarpLUT::makeKey(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                                             int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                                             ofxBezierWarpLUTFormat format, int fractionBits){
+    return makeKey(mesh, meshWidth, meshHeight, ofRectangle(0, 0, srcWidth, srcHeight), srcWidth, srcHeight, dstWidth, dstHeight,
+                   format, fractionBits);
+}
+
+//--------------------------------------------------------------
+unsigned long long ofxBezierWarpLUT::makeKey(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                                             int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                                             ofxBezierWarpLUTFormat format, int fractionBits){
+    
+    fractionBits = getEffectiveFractionBits(format, fractionBits, srcWidth, srcHeight);
+    
+    int params[12] = {
+        (int)lutFileVersion, mesh.getNumXPoints(), mesh.getNumYPoints(),
+        mesh.getGridDivisionsX(), mesh.getGridDivisionsY(), (int)mesh.getMode(),
+        srcWidth, srcHeight, dstWidth, dstHeight, (int)format, fractionBits
+    };
+    
+    const vector<GLfloat>& cntrlPoints = mesh.getControlPointsReference();
+    
+    unsigned long long hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, params, sizeof(params));
+    
+    // the same net on a warp of a different size lands somewhere else
+    float meshSize[2] = {meshWidth, meshHeight};
+    hash = hashBytes(hash, meshSize, sizeof(meshSize));
+    
+    if(cntrlPoints.size() > 0) hash = hashBytes(hash, &cntrlPoints[0], cntrlPoints.size() * sizeof(GLfloat));
+    
+    // lattice edits by what they are - versions don't mean anything on disk
+    // (an unedited lattice draws the same as none so it isn't hashed)
+    const ofxBezierWarpLattice & lattice = mesh.getLatticeReference();
+    if(lattice.getNumEdits() > 0){
+        unsigned long long latticeHash = lattice.getContentHash();
+        hash = hashBytes(hash, &latticeHash, sizeof(latticeHash));
+    }
+    
+    // adaptive meshes depend on the tolerance as well
+    float tolerance = mesh.getAdaptive() ? mesh.getTolerance() : 0.0f;
+    hash = hashBytes(hash, &tolerance, sizeof(tolerance));
+    
+    // only hashed when it isn't the whole source so older cached tables still match
+    if(sourceRect.x != 0 || sourceRect.y != 0 || sourceRect.width != srcWidth || sourceRect.height != srcHeight){
+        float rect[4] = {sourceRect.x, sourceRect.y, sourceRect.width, sourceRect.height};
+        hash = hashBytes(hash, rect, sizeof(rect));
+    }
+    
+    return hash;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getEffectiveFractionBits(ofxBezierWarpLUTFormat format, int fractionBits, int srcWidth, int srcHeight){
+    
+    // FIXED16 has to fit the largest source coordinate in 16 bits
+    // (and keep 0xFFFF free to mark uncovered pixels)
+    
+    if(format == OFX_BEZIER_WARP_LUT_FLOAT) return 0;
+    if(format != OFX_BEZIER_WARP_LUT_FIXED16) return fractionBits;
+    
+    while(fractionBits > 0 && (MAX(srcWidth, srcHeight) - 1) << fractionBits >= OFX_BEZIER_WARP_LUT_FIXED_INVALID) fractionBits--;
+    
+    return fractionBits;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::build(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                             int _srcWidth, int _srcHeight, int dstWidth, int dstHeight,
+                             ofxBezierWarpThreadPool * pool){
+    build(mesh, meshWidth, meshHeight, ofRectangle(0, 0, _srcWidth, _srcHeight), _srcWidth, _srcHeight, dstWidth, dstHeight, pool);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::build(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                             int _srcWidth, int _srcHeight, int dstWidth, int dstHeight,
+                             ofxBezierWarpThreadPool * pool){
+    
+    width = dstWidth;
+    height = dstHeight;
+    srcWidth = _srcWidth;
+    srcHeight = _srcHeight;
+    
+    int bits = getEffectiveFractionBits(format, fractionBits, srcWidth, srcHeight);
+    if(bits != fractionBits){
+        ofLogWarning() << "Source is too big for a 16 bit LUT with " << fractionBits << " fraction bits, using " << bits;
+        fractionBits = bits;
+    }
+    
+    key = makeKey(mesh, meshWidth, meshHeight, sourceRect, srcWidth, srcHeight, width, height, format, fractionBits);
+    
+    coords.resize(width * height * 2);
+    
+    BuildJob job;
+    job.mesh = &mesh;
+    job.scaleX = width / meshWidth;
+    job.scaleY = height / meshHeight;
+    job.coords = &coords[0];
+    job.srcRect = sourceRect;
+    job.dstWidth = width;
+    job.dstHeight = height;
+    
+    int numBands = MIN(height, (pool != NULL ? pool->getNumThreads() : 1) * 4);
+    job.bandHeight = (height + numBands - 1) / numBands;
+    numBands = (height + job.bandHeight - 1) / job.bandHeight;
+    
+    if(pool != NULL){
+        pool->run(job, numBands);
+    }else{
+        for(int i = 0; i < numBands; i++) job.process(i);
+    }
+    
+    encode();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLUT::blend(ofxBezierWarpLUT & a, ofxBezierWarpLUT & b, float t){
+    
+    if(!a.isAllocated() || !b.isAllocated() ||
+       a.format != OFX_BEZIER_WARP_LUT_FLOAT || b.format != OFX_BEZIER_WARP_LUT_FLOAT ||
+       a.width != b.width || a.height != b.height ||
+       a.srcWidth != b.srcWidth || a.srcHeight != b.srcHeight) return false;
+    
+    width = a.width;
+    height = a.height;
+    srcWidth = a.srcWidth;
+    srcHeight = a.srcHeight;
+    format = OFX_BEZIER_WARP_LUT_FLOAT;
+    fractionBits = 0;
+    key = 0;
+    
+    coords.resize(width * height * 2);
+    
+    const float * ca = &a.coords[0];
+    const float * cb = &b.coords[0];
+    
+    // where only one of them covers a pixel use it until the other
+    // is closer so edges move across rather than fading in and out
+    for(int i = 0; i < width * height * 2; i += 2){
+        bool bValidA = ca[i] >= 0.0f;
+        bool bValidB = cb[i] >= 0.0f;
+        if(bValidA && bValidB){
+            coords[i+0] = ca[i+0] + t * (cb[i+0] - ca[i+0]);
+            coords[i+1] = ca[i+1] + t * (cb[i+1] - ca[i+1]);
+        }else if(bValidA && t < 0.5f){
+            coords[i+0] = ca[i+0];
+            coords[i+1] = ca[i+1];
+        }else if(bValidB && t >= 0.5f){
+            coords[i+0] = cb[i+0];
+            coords[i+1] = cb[i+1];
+        }else{
+            coords[i+0] = coords[i+1] = OFX_BEZIER_WARP_LUT_INVALID;
+        }
+    }
+    
+    encode();
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::encode(){
+    
+    fixedCoords.clear();
+    tiles.clear();
+    residuals.clear();
+    raw.clear();
+    numTilesX = 0;
+    numTilesY = 0;
+    
+    if(format == OFX_BEZIER_WARP_LUT_FLOAT) return;
+    
+    // shift to pixel centres and clamp to the source here so
+    // the gather doesn't have to - then convert to fixed point
+    
+    float scale = 1 << fractionBits;
+    for(int i = 0; i < width * height; i++){
+        if(coords[i*2] < 0.0f) continue;
+        coords[i*2+0] = floor(ofClamp(coords[i*2+0] - 0.5f, 0.0f, srcWidth - 1.0f) * scale + 0.5f);
+        coords[i*2+1] = floor(ofClamp(coords[i*2+1] - 0.5f, 0.0f, srcHeight - 1.0f) * scale + 0.5f);
+    }
+    
+    if(format == OFX_BEZIER_WARP_LUT_FIXED16){
+        
+        fixedCoords.resize(width * height * 2);
+        for(int i = 0; i < width * height * 2; i++){
+            fixedCoords[i] = coords[i & ~1] < 0.0f ? OFX_BEZIER_WARP_LUT_FIXED_INVALID : (unsigned short)coords[i];
+        }
+        
+    }else{
+        
+        int tileSize = OFX_BEZIER_WARP_LUT_TILE_SIZE;
+        numTilesX = (width + tileSize - 1) / tileSize;
+        numTilesY = (height + tileSize - 1) / tileSize;
+        
+        tiles.resize(numTilesX * numTilesY);
+        residuals.assign(numTilesX * numTilesY * tileSize * tileSize * 2, 0);
+        
+        for(int ty = 0; ty < numTilesY; ty++){
+            for(int tx = 0; tx < numTilesX; tx++){
+                encodeTile(tx, ty);
+            }
+        }
+    }
+    
+    // only the compact version is kept around
+    vector<float>().swap(coords);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::encodeTile(int tileX, int tileY){
+    
+    int tileSize = OFX_BEZIER_WARP_LUT_TILE_SIZE;
+    int x0 = tileX * tileSize;
+    int y0 = tileY * tileSize;
+    int w = MIN(tileSize, width - x0);
+    int h = MIN(tileSize, height - y0);
+    
+    Tile & tile = tiles[tileY * numTilesX + tileX];
+    signed char * res = &residuals[(tileY * numTilesX + tileX) * tileSize * tileSize * 2];
+    
+    // least squares fit of a plane to x and y over the covered pixels
+    
+    double n = 0, si = 0, sj = 0, sii = 0, sij = 0, sjj = 0;
+    double sx = 0, six = 0, sjx = 0, sy = 0, siy = 0, sjy = 0;
+    
+    for(int j = 0; j < h; j++){
+        for(int i = 0; i < w; i++){
+            const float * c = &coords[((y0 + j) * width + x0 + i) * 2];
+            if(c[0] < 0.0f) continue;
+            n++; si += i; sj += j; sii += i * i; sij += i * j; sjj += j * j;
+            sx += c[0]; six += i * c[0]; sjx += j * c[0];
+            sy += c[1]; siy += i * c[1]; sjy += j * c[1];
+        }
+    }
+    
+    tile.baseX = tile.baseY = 0;
+    tile.stepXX = tile.stepXY = tile.stepYX = tile.stepYY = 0;
+    
+    if(n == 0){
+        tile.rawOffset = -2;
+        return;
+    }
+    
+    double ax = sx / n, bx = 0, cx = 0;
+    double ay = sy / n, by = 0, cy = 0;
+    
+    double det = n * (sii * sjj - sij * sij) - si * (si * sjj - sij * sj) + sj * (si * sij - sii * sj);
+    
+    if(fabs(det) > 1e-6){
+        // cramer's rule on the 3x3 normal equations
+        ax = (sx * (sii * sjj - sij * sij) - si * (six * sjj - sij * sjx) + sj * (six * sij - sii * sjx)) / det;
+        bx = (n * (six * sjj - sij * sjx) - sx * (si * sjj - sij * sj) + sj * (si * sjx - six * sj)) / det;
+        cx = (n * (sii * sjx - six * sij) - si * (si * sjx - six * sj) + sx * (si * sij - sii * sj)) / det;
+        ay = (sy * (sii * sjj - sij * sij) - si * (siy * sjj - sij * sjy) + sj * (siy * sij - sii * sjy)) / det;
+        by = (n * (siy * sjj - sij * sjy) - sy * (si * sjj - sij * sj) + sj * (si * sjy - siy * sj)) / det;
+        cy = (n * (sii * sjy - siy * sij) - si * (si * sjy - siy * sj) + sy * (si * sij - sii * sj)) / det;
+    }
+    
+    tile.baseX = (int)floor(ax + 0.5);
+    tile.baseY = (int)floor(ay + 0.5);
+    tile.stepXX = (int)floor(bx * 256.0 + 0.5);
+    tile.stepXY = (int)floor(by * 256.0 + 0.5);
+    tile.stepYX = (int)floor(cx * 256.0 + 0.5);
+    tile.stepYY = (int)floor(cy * 256.0 + 0.5);
+    tile.rawOffset = -1;
+    
+    bool bFits = true;
+    
+    for(int j = 0; j < tileSize && bFits; j++){
+        for(int i = 0; i < tileSize; i++){
+            signed char * r = &res[(j * tileSize + i) * 2];
+            if(i >= w || j >= h || coords[((y0 + j) * width + x0 + i) * 2] < 0.0f){
+                r[0] = r[1] = OFX_BEZIER_WARP_LUT_RESIDUAL_INVALID;
+                continue;
+            }
+            const float * c = &coords[((y0 + j) * width + x0 + i) * 2];
+            int dx = (int)c[0] - (tile.baseX + ((tile.stepXX * i + tile.stepYX * j) >> 8));
+            int dy = (int)c[1] - (tile.baseY + ((tile.stepXY * i + tile.stepYY * j) >> 8));
+            if(dx < -127 || dx > 127 || dy < -127 || dy > 127){
+                bFits = false;
+                break;
+            }
+            r[0] = dx;
+            r[1] = dy;
+        }
+    }
+    
+    if(bFits) return;
+    
+    // too curved to predict from a plane - store this tile as is
+    
+    tile.rawOffset = raw.size();
+    raw.resize(raw.size() + tileSize * tileSize * 2, -1);
+    
+    for(int j = 0; j < h; j++){
+        for(int i = 0; i < w; i++){
+            const float * c = &coords[((y0 + j) * width + x0 + i) * 2];
+            if(c[0] < 0.0f) continue;
+            raw[tile.rawOffset + (j * tileSize + i) * 2 + 0] = (int)c[0];
+            raw[tile.rawOffset + (j * tileSize + i) * 2 + 1] = (int)c[1];
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::BuildJob::process(int band){
+    
+    int bandBegin = band * bandHeight;
+    int bandEnd = MIN(bandBegin + bandHeight, dstHeight);
+    
+    for(int i = bandBegin * dstWidth * 2; i < bandEnd * dstWidth * 2; i++){
+        coords[i] = OFX_BEZIER_WARP_LUT_INVALID;
+    }
+    
+    ofxBezierWarpRasterizeMesh(*mesh, scaleX, scaleY, dstWidth, bandBegin, bandEnd, *this);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::BuildJob::operator()(int x, int y, float u, float v){
+    coords[(y * dstWidth + x) * 2 + 0] = srcRect.x + u * srcRect.width;
+    coords[(y * dstWidth + x) * 2 + 1] = srcRect.y + v * srcRect.height;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLUT::save(string path){
+    
+    if(!isAllocated()) return false;
+    
+    ofstream file(ofToDataPath(path).c_str(), ios::out | ios::binary);
+    
+    if(!file.is_open()){
+        ofLogError() << "Could not open warp LUT for writing: " << path;
+        return false;
+    }
+    
+    unsigned int header[8] = {lutFileVersion, (unsigned int)width, (unsigned int)height, (unsigned int)srcWidth, (unsigned int)srcHeight,
+                              (unsigned int)format, (unsigned int)fractionBits, OFX_BEZIER_WARP_LUT_TILE_SIZE};
+    unsigned int sizes[5] = {(unsigned int)coords.size(), (unsigned int)fixedCoords.size(), (unsigned int)tiles.size(),
+                             (unsigned int)residuals.size(), (unsigned int)raw.size()};
+    
+    unsigned long long checksum = makeChecksum(header, key, sizes, coords, fixedCoords, tiles, residuals, raw);
+    
+    file.write(lutMagic, sizeof(lutMagic));
+    file.write((const char *)header, sizeof(header));
+    file.write((const char *)&key, sizeof(key));
+    file.write((const char *)sizes, sizeof(sizes));
+    file.write((const char *)&checksum, sizeof(checksum));
+    if(sizes[0] > 0) file.write((const char *)&coords[0], sizes[0] * sizeof(float));
+    if(sizes[1] > 0) file.write((const char *)&fixedCoords[0], sizes[1] * sizeof(unsigned short));
+    if(sizes[2] > 0) file.write((const char *)&tiles[0], sizes[2] * sizeof(Tile));
+    if(sizes[3] > 0) file.write((const char *)&residuals[0], sizes[3] * sizeof(signed char));
+    if(sizes[4] > 0) file.write((const char *)&raw[0], sizes[4] * sizeof(int));
+    
+    return file.good();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLUT::load(string path){
+    
+    ifstream file(ofToDataPath(path).c_str(), ios::in | ios::binary);
+    
+    if(!file.is_open()) return false;
+    
+    char magic[8];
+    unsigned int header[8];
+    unsigned long long fileKey;
+    unsigned int sizes[5];
+    unsigned long long checksum;
+    
+    file.read(magic, sizeof(magic));
+    file.read((char *)header, sizeof(header));
+    file.read((char *)&fileKey, sizeof(fileKey));
+    file.read((char *)sizes, sizeof(sizes));
+    file.read((char *)&checksum, sizeof(checksum));
+    
+    if(!file.good() || memcmp(magic, lutMagic, sizeof(magic)) != 0 || header[0] != lutFileVersion ||
+       header[1] == 0 || header[2] == 0 || header[1] > 32768 || header[2] > 32768 ||
+       header[3] == 0 || header[4] == 0 || header[3] > 65536 || header[4] > 65536 ||
+       header[5] > OFX_BEZIER_WARP_LUT_TILE_DELTA || header[6] > 8 || header[7] != OFX_BEZIER_WARP_LUT_TILE_SIZE){
+        ofLogWarning() << "Not a valid warp LUT file: " << path;
+        return false;
+    }
+    
+    // the table sizes all follow from the header so anything that doesn't
+    // add up is rejected before allocating
+    unsigned int tileSize = OFX_BEZIER_WARP_LUT_TILE_SIZE;
+    unsigned int tileValues = tileSize * tileSize * 2;
+    unsigned int numPixelValues = header[1] * header[2] * 2;
+    unsigned int numTiles = ((header[1] + tileSize - 1) / tileSize) * ((header[2] + tileSize - 1) / tileSize);
+    
+    bool bSizesMatch = false;
+    switch(header[5]){
+        case OFX_BEZIER_WARP_LUT_FLOAT:
+            bSizesMatch = sizes[0] == numPixelValues && sizes[1] == 0 && sizes[2] == 0 && sizes[3] == 0 && sizes[4] == 0;
+            break;
+        case OFX_BEZIER_WARP_LUT_FIXED16:
+            bSizesMatch = sizes[0] == 0 && sizes[1] == numPixelValues && sizes[2] == 0 && sizes[3] == 0 && sizes[4] == 0;
+            break;
+        case OFX_BEZIER_WARP_LUT_TILE_DELTA:
+            bSizesMatch = sizes[0] == 0 && sizes[1] == 0 && sizes[2] == numTiles && sizes[3] == numTiles * tileValues &&
+                          sizes[4] % tileValues == 0 && sizes[4] <= numTiles * tileValues;
+            break;
+    }
+    
+    if(!bSizesMatch){
+        ofLogWarning() << "Warp LUT tables don't match its size and format: " << path;
+        return false;
+    }
+    
+    vector<float> fileCoords(sizes[0]);
+    vector<unsigned short> fileFixedCoords(sizes[1]);
+    vector<Tile> fileTiles(sizes[2]);
+    vector<signed char> fileResiduals(sizes[3]);
+    vector<int> fileRaw(sizes[4]);
+    
+    if(sizes[0] > 0) file.read((char *)&fileCoords[0], sizes[0] * sizeof(float));
+    if(sizes[1] > 0) file.read((char *)&fileFixedCoords[0], sizes[1] * sizeof(unsigned short));
+    if(sizes[2] > 0) file.read((char *)&fileTiles[0], sizes[2] * sizeof(Tile));
+    if(sizes[3] > 0) file.read((char *)&fileResiduals[0], sizes[3] * sizeof(signed char));
+    if(sizes[4] > 0) file.read((char *)&fileRaw[0], sizes[4] * sizeof(int));
+    
+    if(!file.good()){
+        ofLogWarning() << "Warp LUT file is truncated: " << path;
+        return false;
+    }
+    
+    if(makeChecksum(header, fileKey, sizes, fileCoords, fileFixedCoords, fileTiles, fileResiduals, fileRaw) != checksum){
+        ofLogWarning() << "Warp LUT checksum doesn't match: " << path;
+        return false;
+    }
+    
+    // the gathers trust the table contents (the build already clamped them)
+    // so make sure nothing points outside the source or the raw data
+    unsigned int maxX = (header[3] - 1) << header[6];
+    unsigned int maxY = (header[4] - 1) << header[6];
+    
+    for(size_t i = 0; i < fileFixedCoords.size(); i += 2){
+        if(fileFixedCoords[i] == OFX_BEZIER_WARP_LUT_FIXED_INVALID) continue;
+        if(fileFixedCoords[i] > maxX || fileFixedCoords[i + 1] > maxY){
+            ofLogWarning() << "Warp LUT points outside its source: " << path;
+            return false;
+        }
+    }
+    
+    for(size_t i = 0; i < fileTiles.size(); i++){
+        int offset = fileTiles[i].rawOffset;
+        if(offset < -2 || (offset >= 0 && (offset % tileValues != 0 || offset + tileValues > fileRaw.size()))){
+            ofLogWarning() << "Warp LUT tile points outside its data: " << path;
+            return false;
+        }
+    }
+    
+    // tiles only store a plane and residuals, so decode every pixel the
+    // same way the gather does and check where it lands
+    int fileTilesX = (header[1] + tileSize - 1) / tileSize;
+    
+    for(size_t t = 0; t < fileTiles.size(); t++){
+        const Tile & tile = fileTiles[t];
+        if(tile.rawOffset == -2) continue;
+        int w = MIN((int)tileSize, (int)header[1] - (int)(t % fileTilesX) * (int)tileSize);
+        int h = MIN((int)tileSize, (int)header[2] - (int)(t / fileTilesX) * (int)tileSize);
+        bool bInside = true;
+        for(int j = 0; j < h && bInside; j++){
+            for(int i = 0; i < w; i++){
+                int cx, cy;
+                if(tile.rawOffset >= 0){
+                    const int * c = &fileRaw[tile.rawOffset + (j * tileSize + i) * 2];
+                    if(c[0] < 0) continue;
+                    cx = c[0];
+                    cy = c[1];
+                }else{
+                    const signed char * r = &fileResiduals[(t * tileSize * tileSize + j * tileSize + i) * 2];
+                    if(r[0] == OFX_BEZIER_WARP_LUT_RESIDUAL_INVALID) continue;
+                    cx = tile.baseX + ((tile.stepXX * i + tile.stepYX * j) >> 8) + r[0];
+                    cy = tile.baseY + ((tile.stepXY * i + tile.stepYY * j) >> 8) + r[1];
+                }
+                if(cx < 0 || cy < 0 || (unsigned int)cx > maxX || (unsigned int)cy > maxY){
+                    bInside = false;
+                    break;
+                }
+            }
+        }
+        if(!bInside){
+            ofLogWarning() << "Warp LUT tile points outside its source: " << path;
+            return false;
+        }
+    }
+    
+    width = header[1];
+    height = header[2];
+    srcWidth = header[3];
+    srcHeight = header[4];
+    format = (ofxBezierWarpLUTFormat)header[5];
+    fractionBits = header[6];
+    numTilesX = (width + OFX_BEZIER_WARP_LUT_TILE_SIZE - 1) / OFX_BEZIER_WARP_LUT_TILE_SIZE;
+    numTilesY = (height + OFX_BEZIER_WARP_LUT_TILE_SIZE - 1) / OFX_BEZIER_WARP_LUT_TILE_SIZE;
+    key = fileKey;
+    
+    coords.swap(fileCoords);
+    fixedCoords.swap(fileFixedCoords);
+    tiles.swap(fileTiles);
+    residuals.swap(fileResiduals);
+    raw.swap(fileRaw);
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::clear(){
+    width = 0;
+    height = 0;
+    srcWidth = 0;
+    srcHeight = 0;
+    key = 0;
+    numTilesX = 0;
+    numTilesY = 0;
+    coords.clear();
+    fixedCoords.clear();
+    tiles.clear();
+    residuals.clear();
+    raw.clear();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLUT::isAllocated(){
+    return coords.size() > 0 || fixedCoords.size() > 0 || tiles.size() > 0;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLUT::setFormat(ofxBezierWarpLUTFormat _format, int _fractionBits){
+    
+    _fractionBits = MAX(0, MIN(_fractionBits, 8));
+    
+    // the table needs rebuilding in the new format
+    if(_format != format || _fractionBits != fractionBits) clear();
+    
+    format = _format;
+    fractionBits = (format == OFX_BEZIER_WARP_LUT_FLOAT ? 0 : _fractionBits);
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLUTFormat ofxBezierWarpLUT::getFormat(){
+    return format;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getFractionBits(){
+    return fractionBits;
+}
+
+//--------------------------------------------------------------
+size_t ofxBezierWarpLUT::getSizeInBytes(){
+    return coords.size() * sizeof(float) + fixedCoords.size() * sizeof(unsigned short) +
+           tiles.size() * sizeof(Tile) + residuals.size() + raw.size() * sizeof(int);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getWidth(){
+    return width;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getHeight(){
+    return height;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getSourceWidth(){
+    return srcWidth;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getSourceHeight(){
+    return srcHeight;
+}
+
+//--------------------------------------------------------------
+unsigned long long ofxBezierWarpLUT::getKey(){
+    return key;
+}
+
+//--------------------------------------------------------------
+float * ofxBezierWarpLUT::getData(){
+    return coords.size() > 0 ? &coords[0] : NULL;
+}
+
+//--------------------------------------------------------------
+vector<float>& ofxBezierWarpLUT::getDataReference(){
+    return coords;
+}
+
+//--------------------------------------------------------------
+unsigned short * ofxBezierWarpLUT::getFixedData(){
+    return fixedCoords.size() > 0 ? &fixedCoords[0] : NULL;
+}
+
+//--------------------------------------------------------------
+vector<unsigned short>& ofxBezierWarpLUT::getFixedDataReference(){
+    return fixedCoords;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLUT::getCoord(int x, int y, float & sx, float & sy){
+    
+    // the compact formats are stored shifted back by half a pixel
+    
+    float scale = 1.0f / (1 << fractionBits);
+    
+    switch(format){
+        case OFX_BEZIER_WARP_LUT_FLOAT:{
+            const float * c = &coords[(y * width + x) * 2];
+            sx = c[0]; sy = c[1];
+            return c[0] >= 0.0f;
+        }
+        case OFX_BEZIER_WARP_LUT_FIXED16:{
+            const unsigned short * c = &fixedCoords[(y * width + x) * 2];
+            sx = c[0] * scale + 0.5f; sy = c[1] * scale + 0.5f;
+            return c[0] != OFX_BEZIER_WARP_LUT_FIXED_INVALID;
+        }
+        case OFX_BEZIER_WARP_LUT_TILE_DELTA:{
+            int tileSize = OFX_BEZIER_WARP_LUT_TILE_SIZE;
+            int tileIndex = (y / tileSize) * numTilesX + x / tileSize;
+            int i = x % tileSize, j = y % tileSize;
+            const Tile & tile = tiles[tileIndex];
+            if(tile.rawOffset == -2) return false;
+            if(tile.rawOffset >= 0){
+                const int * c = &raw[tile.rawOffset + (j * tileSize + i) * 2];
+                sx = c[0] * scale + 0.5f; sy = c[1] * scale + 0.5f;
+                return c[0] >= 0;
+            }
+            const signed char * r = &residuals[((tileIndex * tileSize + j) * tileSize + i) * 2];
+            if(r[0] == OFX_BEZIER_WARP_LUT_RESIDUAL_INVALID) return false;
+            sx = (tile.baseX + ((tile.stepXX * i + tile.stepYX * j) >> 8) + r[0]) * scale + 0.5f;
+            sy = (tile.baseY + ((tile.stepXY * i + tile.stepYY * j) >> 8) + r[1]) * scale + 0.5f;
+            return true;
+        }
+    }
+    return false;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getNumTilesX(){
+    return numTilesX;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLUT::getNumTilesY(){
+    return numTilesY;
+}
+
+//--------------------------------------------------------------
+vector<ofxBezierWarpLUT::Tile>& ofxBezierWarpLUT::getTilesReference(){
+    return tiles;
+}
+
+//--------------------------------------------------------------
+vector<signed char>& ofxBezierWarpLUT::getResidualsReference(){
+    return residuals;
+}
+
+//--------------------------------------------------------------
+vector<int>& ofxBezierWarpLUT::getRawReference(){
+    return raw;
+}
@@ -0,0 +1,189 @@
+/*
+ * ofxBezierWarpLUT.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPLUT
+#define _H_OFXBEZIERWARPLUT
+
+#include "ofxBezierWarpMesh.h"
+#include "ofxBezierWarpThreadPool.h"
+
+// anything the warp doesn't cover is marked with a negative coordinate
+#define OFX_BEZIER_WARP_LUT_INVALID -1.0f
+
+// the compact formats mark uncovered pixels with these instead
+#define OFX_BEZIER_WARP_LUT_FIXED_INVALID 0xFFFF
+#define OFX_BEZIER_WARP_LUT_RESIDUAL_INVALID -128
+
+#define OFX_BEZIER_WARP_LUT_TILE_SIZE 16
+
+enum ofxBezierWarpLUTFormat {
+    OFX_BEZIER_WARP_LUT_FLOAT = 0,      // 2 floats per pixel (8 bytes)
+    OFX_BEZIER_WARP_LUT_FIXED16,        // 2 unsigned shorts per pixel in fixed point (4 bytes)
+    OFX_BEZIER_WARP_LUT_TILE_DELTA      // per tile affine fit + 2 signed chars per pixel (~2 bytes)
+};
+
+// dense output -> source lookup table for the CPU remap - for every
+// output pixel it holds the source pixel coordinate (x, y) to sample
+// so once it is built a remap is a pure gather with no surface maths
+//
+// tables can be saved to disk and are keyed by a hash of everything
+// they depend on (control net, grid, mode, source and output size)
+//
+// the compact formats store coordinates already shifted to pixel centres
+// and clamped to the source in fixed point with fractionBits bits for the
+// bilinear weights - fewer bits means a smaller table but coarser
+// filtering (and FIXED16 needs (srcWidth << fractionBits) to fit in 16 bits)
+
+class ofxBezierWarpLUT {
+    
+public:
+	
+    ofxBezierWarpLUT();
+    ~ofxBezierWarpLUT();
+    
+    void build(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+               int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+               ofxBezierWarpThreadPool * pool = NULL);
+    
+    // maps the warp onto sourceRect (in pixels) of a srcWidth x srcHeight
+    // source, so several warps can share one buffer
+    void build(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+               int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+               ofxBezierWarpThreadPool * pool = NULL);
+    
+    // mixes two float tables of the same size pixel by pixel - it's only
+    // an approximation of the table for the in between warp (the inverse
+    // mapping isn't linear) but it's smooth and costs no rasterizing
+    bool blend(ofxBezierWarpLUT & a, ofxBezierWarpLUT & b, float t);
+    
+    void setFormat(ofxBezierWarpLUTFormat format, int fractionBits = 4);
+    ofxBezierWarpLUTFormat getFormat();
+    int getFractionBits();
+    
+    size_t getSizeInBytes();
+    
+    bool save(string path);
+    bool load(string path);
+    
+    void clear();
+    bool isAllocated();
+    
+    int getWidth();
+    int getHeight();
+    int getSourceWidth();
+    int getSourceHeight();
+    
+    // source position output pixel x, y reads from (pixel centres at +0.5
+    // whatever the format) - false where the warp doesn't cover it
+    bool getCoord(int x, int y, float & sx, float & sy);
+    
+    unsigned long long getKey();
+    
+    // OFX_BEZIER_WARP_LUT_FLOAT
+    float * getData();
+    vector<float>& getDataReference();
+    
+    // OFX_BEZIER_WARP_LUT_FIXED16 - x, y pairs
+    unsigned short * getFixedData();
+    vector<unsigned short>& getFixedDataReference();
+    
+    // OFX_BEZIER_WARP_LUT_TILE_DELTA - the coordinate of pixel (i, j) inside
+    // a tile is base + ((stepX * i + stepY * j) >> 8) + residual(i, j)
+    struct Tile {
+        int baseX;
+        int baseY;
+        int stepXX;     // change in x along a row (8 extra fraction bits)
+        int stepXY;     // change in y along a row
+        int stepYX;     // change in x down a column
+        int stepYY;     // change in y down a column
+        int rawOffset;  // -1 uses residuals, -2 is empty, otherwise an offset into the raw data
+    };
+    
+    int getNumTilesX();
+    int getNumTilesY();
+    vector<Tile>& getTilesReference();
+    vector<signed char>& getResidualsReference();
+    vector<int>& getRawReference();
+    
+    static unsigned long long makeKey(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                                      int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                                      ofxBezierWarpLUTFormat format = OFX_BEZIER_WARP_LUT_FLOAT, int fractionBits = 0);
+    static unsigned long long makeKey(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                                      int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                                      ofxBezierWarpLUTFormat format = OFX_BEZIER_WARP_LUT_FLOAT, int fractionBits = 0);
+    
+    static int getEffectiveFractionBits(ofxBezierWarpLUTFormat format, int fractionBits, int srcWidth, int srcHeight);
+    
+protected:
+	
+    void encode();
+    void encodeTile(int tileX, int tileY);
+    
+    class BuildJob : public ofxBezierWarpJob {
+    public:
+        void process(int band);
+        void operator()(int x, int y, float u, float v);
+        ofxBezierWarpMesh * mesh;
+        float scaleX;
+        float scaleY;
+        float * coords;
+        ofRectangle srcRect;
+        int dstWidth;
+        int dstHeight;
+        int bandHeight;
+    };
+    
+    int width;
+    int height;
+    int srcWidth;
+    int srcHeight;
+    
+    unsigned long long key;
+    
+    ofxBezierWarpLUTFormat format;
+    int fractionBits;
+    
+    vector<float> coords;
+    vector<unsigned short> fixedCoords;
+    
+    int numTilesX;
+    int numTilesY;
+    vector<Tile> tiles;
+    vector<signed char> residuals;
+    vector<int> raw;
+    
+private:
+	
+};
+
+#endif
@@ -0,0 +1,419 @@
+/*
+ * ofxBezierWarpLattice.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpLattice.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+volatile long ofxBezierWarpLattice::nextVersion = 0;
+
+//--------------------------------------------------------------
+static unsigned long long hashBytes(unsigned long long hash, const void * data, size_t size){
+    // 64 bit FNV-1a
+    const unsigned char * bytes = (const unsigned char *)data;
+    for(size_t i = 0; i < size; i++){
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLattice::ofxBezierWarpLattice(){
+    numXCells = 0;
+    numYCells = 0;
+    version = 0;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLattice::~ofxBezierWarpLattice(){
+    levels.clear();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::setup(int _numXCells, int _numYCells, int numLevels){
+    
+    if(_numXCells < 1 || _numYCells < 1 || numLevels < 0){
+        ofLogError() << "Lattice needs at least one cell each way";
+        return;
+    }
+    
+    // 16 levels is already 65536 times finer than the net
+    numLevels = MIN(numLevels, 16);
+    
+    numXCells = _numXCells;
+    numYCells = _numYCells;
+    
+    levels.resize(numLevels);
+    for(int l = 0; l < numLevels; l++){
+        levels[l].numXNodes = (numXCells << l) + 1;
+        levels[l].numYNodes = (numYCells << l) + 1;
+        levels[l].offsets.clear();
+    }
+    
+    changed();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLattice::isSetup() const{
+    return levels.size() > 0;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLattice::isSameSetup(const ofxBezierWarpLattice & other) const{
+    return numXCells == other.numXCells && numYCells == other.numYCells && levels.size() == other.levels.size();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::clear(){
+    if(getNumEdits() == 0) return;
+    for(size_t l = 0; l < levels.size(); l++) levels[l].offsets.clear();
+    changed();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLattice::getNumLevels() const{
+    return levels.size();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLattice::getNumXCells() const{
+    return numXCells;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLattice::getNumYCells() const{
+    return numYCells;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLattice::getNumXNodes(int level) const{
+    if(level < 0 || level >= (int)levels.size()) return 0;
+    return levels[level].numXNodes;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLattice::getNumYNodes(int level) const{
+    if(level < 0 || level >= (int)levels.size()) return 0;
+    return levels[level].numYNodes;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLattice::getNumEdits() const{
+    int n = 0;
+    for(size_t l = 0; l < levels.size(); l++) n += levels[l].offsets.size();
+    return n;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpLattice::getNumEdits(int level) const{
+    if(level < 0 || level >= (int)levels.size()) return 0;
+    return levels[level].offsets.size();
+}
+
+//--------------------------------------------------------------
+ofPoint ofxBezierWarpLattice::getNodeTexCoord(int level, int i, int j) const{
+    if(level < 0 || level >= (int)levels.size()) return ofPoint();
+    const Level & lattice = levels[level];
+    return ofPoint((float)i / (lattice.numXNodes - 1), (float)j / (lattice.numYNodes - 1));
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::getNearestNode(int level, float u, float v, int & i, int & j) const{
+    i = j = -1;
+    if(level < 0 || level >= (int)levels.size()) return;
+    const Level & lattice = levels[level];
+    i = ofClamp(floorf(u * (lattice.numXNodes - 1) + 0.5f), 0, lattice.numXNodes - 1);
+    j = ofClamp(floorf(v * (lattice.numYNodes - 1) + 0.5f), 0, lattice.numYNodes - 1);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::setOffset(int level, int i, int j, ofPoint offset){
+    
+    if(level < 0 || level >= (int)levels.size()) return;
+    
+    Level & lattice = levels[level];
+    if(i < 0 || j < 0 || i >= lattice.numXNodes || j >= lattice.numYNodes) return;
+    
+    // nodes that go back to nothing stop costing anything
+    if(offset.x == 0.0f && offset.y == 0.0f && offset.z == 0.0f){
+        if(lattice.offsets.erase(j * lattice.numXNodes + i) > 0) changed();
+        return;
+    }
+    
+    lattice.offsets[j * lattice.numXNodes + i] = offset;
+    changed();
+}
+
+//--------------------------------------------------------------
+ofPoint ofxBezierWarpLattice::getOffset(int level, int i, int j) const{
+    
+    if(level < 0 || level >= (int)levels.size()) return ofPoint();
+    
+    const Level & lattice = levels[level];
+    map<int, ofPoint>::const_iterator it = lattice.offsets.find(j * lattice.numXNodes + i);
+    
+    return it != lattice.offsets.end() ? it->second : ofPoint();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::moveNode(int level, int i, int j, ofPoint delta){
+    // the node's own bump is bspline(0)^2 = 4/9 high right on top of it
+    setOffset(level, i, j, getOffset(level, i, j) + delta * 2.25f);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::resetNode(int level, int i, int j){
+    setOffset(level, i, j, ofPoint());
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::getEdits(vector<Edit> & edits) const{
+    
+    edits.clear();
+    
+    for(size_t l = 0; l < levels.size(); l++){
+        const Level & lattice = levels[l];
+        for(map<int, ofPoint>::const_iterator it = lattice.offsets.begin(); it != lattice.offsets.end(); ++it){
+            Edit edit;
+            edit.level = l;
+            edit.i = it->first % lattice.numXNodes;
+            edit.j = it->first / lattice.numXNodes;
+            edit.offset = it->second;
+            edits.push_back(edit);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+ofPoint ofxBezierWarpLattice::getDisplacement(float u, float v) const{
+    GLfloat p[3] = {0.0f, 0.0f, 0.0f};
+    addDisplacement(u, v, p);
+    return ofPoint(p[0], p[1], p[2]);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::addDisplacement(float u, float v, GLfloat * p) const{
+    
+    for(size_t l = 0; l < levels.size(); l++){
+        
+        const Level & lattice = levels[l];
+        if(lattice.offsets.empty()) continue;
+        
+        float x = u * (lattice.numXNodes - 1);
+        float y = v * (lattice.numYNodes - 1);
+        
+        // a few edits are quicker to just run through than to look up
+        // the 4x4 nodes that could be under the point
+        if(lattice.offsets.size() < 16){
+            for(map<int, ofPoint>::const_iterator it = lattice.offsets.begin(); it != lattice.offsets.end(); ++it){
+                float w = bspline(x - it->first % lattice.numXNodes) * bspline(y - it->first / lattice.numXNodes);
+                if(w == 0.0f) continue;
+                p[0] += it->second.x * w;
+                p[1] += it->second.y * w;
+                p[2] += it->second.z * w;
+            }
+            continue;
+        }
+        
+        int i0 = MAX((int)floorf(x) - 1, 0), i1 = MIN((int)floorf(x) + 2, lattice.numXNodes - 1);
+        int j0 = MAX((int)floorf(y) - 1, 0), j1 = MIN((int)floorf(y) + 2, lattice.numYNodes - 1);
+        
+        for(int j = j0; j <= j1; j++){
+            float wy = bspline(y - j);
+            if(wy == 0.0f) continue;
+            for(int i = i0; i <= i1; i++){
+                map<int, ofPoint>::const_iterator it = lattice.offsets.find(j * lattice.numXNodes + i);
+                if(it == lattice.offsets.end()) continue;
+                float w = bspline(x - i) * wy;
+                p[0] += it->second.x * w;
+                p[1] += it->second.y * w;
+                p[2] += it->second.z * w;
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::addDisplacement(GLfloat * vertices, int gridDivX, int gridDivY, int colBegin, int colEnd, int rowBegin, int rowEnd) const{
+    
+    int numCols = gridDivX + 1;
+    vector<float> wx;
+    
+    for(size_t l = 0; l < levels.size(); l++){
+        
+        const Level & lattice = levels[l];
+        int divX = lattice.numXNodes - 1;
+        int divY = lattice.numYNodes - 1;
+        
+        for(map<int, ofPoint>::const_iterator it = lattice.offsets.begin(); it != lattice.offsets.end(); ++it){
+            
+            int i = it->first % lattice.numXNodes;
+            int j = it->first / lattice.numXNodes;
+            const ofPoint & offset = it->second;
+            
+            // the samples strictly inside the bump's two spans either side
+            int c0 = MAX(colBegin, (int)floorf((float)(i - 2) * gridDivX / divX) + 1);
+            int c1 = MIN(colEnd, (int)ceilf((float)(i + 2) * gridDivX / divX));
+            int r0 = MAX(rowBegin, (int)floorf((float)(j - 2) * gridDivY / divY) + 1);
+            int r1 = MIN(rowEnd, (int)ceilf((float)(j + 2) * gridDivY / divY));
+            if(c0 >= c1 || r0 >= r1) continue;
+            
+            wx.resize(c1 - c0);
+            for(int c = c0; c < c1; c++) wx[c - c0] = bspline((float)c * divX / gridDivX - i);
+            
+            for(int r = r0; r < r1; r++){
+                float wy = bspline((float)r * divY / gridDivY - j);
+                GLfloat * vert = &vertices[(r * numCols + c0) * 3];
+                for(int c = c0; c < c1; c++, vert += 3){
+                    float w = wx[c - c0] * wy;
+                    vert[0] += offset.x * w;
+                    vert[1] += offset.y * w;
+                    vert[2] += offset.z * w;
+                }
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::setDifference(const ofxBezierWarpLattice & to, const ofxBezierWarpLattice & from){
+    
+    numXCells = to.numXCells;
+    numYCells = to.numYCells;
+    levels.resize(to.levels.size());
+    
+    for(size_t l = 0; l < levels.size(); l++){
+        
+        Level & lattice = levels[l];
+        lattice.numXNodes = to.levels[l].numXNodes;
+        lattice.numYNodes = to.levels[l].numYNodes;
+        lattice.offsets.clear();
+        
+        const map<int, ofPoint> & a = to.levels[l].offsets;
+        const map<int, ofPoint> & b = from.levels[l].offsets;
+        map<int, ofPoint>::const_iterator ia = a.begin(), ib = b.begin();
+        
+        // both are sorted so walk them together
+        while(ia != a.end() || ib != b.end()){
+            if(ib == b.end() || (ia != a.end() && ia->first < ib->first)){
+                lattice.offsets.insert(lattice.offsets.end(), *ia);
+                ++ia;
+            }else if(ia == a.end() || ib->first < ia->first){
+                lattice.offsets.insert(lattice.offsets.end(), make_pair(ib->first, -ib->second));
+                ++ib;
+            }else{
+                if(ia->second != ib->second) lattice.offsets.insert(lattice.offsets.end(), make_pair(ia->first, ia->second - ib->second));
+                ++ia;
+                ++ib;
+            }
+        }
+    }
+    
+    changed();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpLattice::blend(const ofxBezierWarpLattice & a, const ofxBezierWarpLattice & b, float t){
+    
+    if(!a.isSameSetup(b)) return false;
+    
+    // mixing with nothing (or itself) is a lot simpler
+    ofxBezierWarpLattice difference;
+    difference.setDifference(b, a);
+    
+    *this = a;
+    
+    for(size_t l = 0; l < levels.size(); l++){
+        map<int, ofPoint> & offsets = levels[l].offsets;
+        const map<int, ofPoint> & deltas = difference.levels[l].offsets;
+        for(map<int, ofPoint>::const_iterator it = deltas.begin(); it != deltas.end(); ++it){
+            offsets[it->first] += it->second * t;
+        }
+    }
+    
+    changed();
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBezierWarpLattice::getVersion() const{
+    return version;
+}
+
+//--------------------------------------------------------------
+unsigned long long ofxBezierWarpLattice::getContentHash() const{
+    
+    // the level sizes then each level's edits (maps are sorted so
+    // the same edits always go in in the same order)
+    unsigned long long hash = 14695981039346656037ULL;
+    
+    for(size_t l = 0; l < levels.size(); l++){
+        
+        const Level & lattice = levels[l];
+        int size[3] = {lattice.numXNodes, lattice.numYNodes, (int)lattice.offsets.size()};
+        hash = hashBytes(hash, size, sizeof(size));
+        
+        for(map<int, ofPoint>::const_iterator it = lattice.offsets.begin(); it != lattice.offsets.end(); ++it){
+            int key = it->first;
+            float offset[3] = {it->second.x, it->second.y, it->second.z};
+            hash = hashBytes(hash, &key, sizeof(key));
+            hash = hashBytes(hash, offset, sizeof(offset));
+        }
+    }
+    
+    return hash;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpLattice::bspline(float t){
+    // uniform cubic b-spline centred on 0, zero from 2 spans out
+    t = fabsf(t);
+    if(t < 1.0f) return (4.0f - 6.0f * t * t + 3.0f * t * t * t) / 6.0f;
+    if(t < 2.0f) return (2.0f - t) * (2.0f - t) * (2.0f - t) / 6.0f;
+    return 0.0f;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpLattice::changed(){
+    // lattices change on the UI thread and inside mesh updates on the
+    // tessellator's so the counter has to be bumped atomically
+#ifdef _MSC_VER
+    version = (unsigned int)_InterlockedIncrement(&nextVersion);
+#else
+    version = (unsigned int)__sync_add_and_fetch(&nextVersion, 1);
+#endif
+}
@@ -0,0 +1,137 @@
+/*
+ * ofxBezierWarpLattice.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPLATTICE
+#define _H_OFXBEZIERWARPLATTICE
+
+#include "ofGraphics.h"
+#include <map>
+
+// finer levels of control on top of the bezier net: each level is a
+// lattice over the surface (in uv) with twice the nodes of the one
+// below, and a node only exists once it has been moved. Nodes push the
+// surface around with a cubic b-spline bump two lattice spans wide, so
+// an edit stays local and smooth. Only edits are stored - memory and
+// the work to apply them grow with the number of edits, not with how
+// fine the levels go
+//
+// level l has numXCells << l by numYCells << l cells (level 0 is usually
+// the span between two control points of the net)
+
+class ofxBezierWarpLattice {
+    
+public:
+	
+    ofxBezierWarpLattice();
+    ~ofxBezierWarpLattice();
+    
+    // changing the levels throws away the edits
+    void setup(int numXCells, int numYCells, int numLevels = 4);
+    bool isSetup() const;
+    bool isSameSetup(const ofxBezierWarpLattice & other) const;
+    
+    // forgets the edits but keeps the levels
+    void clear();
+    
+    int getNumLevels() const;
+    int getNumXCells() const;
+    int getNumYCells() const;
+    int getNumXNodes(int level) const;
+    int getNumYNodes(int level) const;
+    int getNumEdits() const;
+    int getNumEdits(int level) const;
+    
+    // where a node sits on the surface (normalized like the mesh texcoords)
+    ofPoint getNodeTexCoord(int level, int i, int j) const;
+    void getNearestNode(int level, float u, float v, int & i, int & j) const;
+    
+    // the node's b-spline coefficient in warp pixels - moveNode() changes
+    // it so the surface right at the node moves by exactly delta
+    void setOffset(int level, int i, int j, ofPoint offset);
+    ofPoint getOffset(int level, int i, int j) const;
+    void moveNode(int level, int i, int j, ofPoint delta);
+    void resetNode(int level, int i, int j);
+    
+    // every edit there is - eg., for saving them
+    struct Edit {
+        int level;
+        int i;
+        int j;
+        ofPoint offset;
+    };
+    void getEdits(vector<Edit> & edits) const;
+    
+    ofPoint getDisplacement(float u, float v) const;
+    void addDisplacement(float u, float v, GLfloat * p) const;
+    
+    // adds every edit to the samples [colBegin, colEnd) x [rowBegin, rowEnd)
+    // of a uniform (gridDivX + 1) x (gridDivY + 1) grid of xyz vertices,
+    // only touching the samples under each one
+    void addDisplacement(GLfloat * vertices, int gridDivX, int gridDivY, int colBegin, int colEnd, int rowBegin, int rowEnd) const;
+    
+    // what changed going from one lattice to another (this = to - from)
+    void setDifference(const ofxBezierWarpLattice & to, const ofxBezierWarpLattice & from);
+    
+    // mixes the offsets of two lattices with the same setup
+    bool blend(const ofxBezierWarpLattice & a, const ofxBezierWarpLattice & b, float t);
+    
+    // unique across all lattices so a copy can tell it is stale
+    unsigned int getVersion() const;
+    
+    // hash of the levels and every edit, the same for equal lattices
+    // wherever (and whenever) they were made - eg., for LUT cache keys
+    unsigned long long getContentHash() const;
+    
+protected:
+	
+    struct Level {
+        int numXNodes;
+        int numYNodes;
+        map<int, ofPoint> offsets;
+    };
+    
+    static float bspline(float t);
+    void changed();
+    
+    vector<Level> levels;
+    int numXCells;
+    int numYCells;
+    unsigned int version;
+    
+    static volatile long nextVersion;
+    
+private:
+	
+};
+
+#endif
@@ -0,0 +1,527 @@
+/*
+ * ofxBezierWarpManager.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#include "ofxBezierWarpManager.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpManager::ofxBezierWarpManager(){
+    bNeedsPack = true;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpManager::~ofxBezierWarpManager(){
+    clear();
+}
+
+//--------------------------------------------------------------
+ofxBezierWarp& ofxBezierWarpManager::addWarp(int w, int h, int numXPoints, int numYPoints, float pixelsPerGridDivision, bool bAllocateFbo){
+    
+    Entry entry;
+    entry.warp = new ofxBezierWarp();
+    entry.outputRect.set(0, 0, w, h);
+    entry.sourceRect.set(0, 0, w, h);
+    entry.bSourceRect = false;
+    entry.mesh = NULL;
+    entry.meshVersion = 0;
+    entry.gridDivX = entry.gridDivY = 0;
+    entry.vertexOffset = entry.numVertices = 0;
+    entry.indexOffset = entry.numIndices = 0;
+    entry.lut = new ofxBezierWarpLUT();
+    entry.mask = new ofxBezierWarpMask();
+    entry.lutMesh = NULL;
+    entry.lutMeshVersion = 0;
+    entry.bLUTDirty = true;
+    
+    if(bAllocateFbo){
+        entry.warp->allocate(w, h, numXPoints, numYPoints, pixelsPerGridDivision);
+    }else{
+        entry.warp->setup(w, h, numXPoints, numYPoints, pixelsPerGridDivision);
+    }
+    
+    entries.push_back(entry);
+    bNeedsPack = true;
+    
+    return *entry.warp;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::removeWarp(int index){
+    if(index < 0 || index >= (int)entries.size()) return;
+    deleteEntry(entries[index]);
+    entries.erase(entries.begin() + index);
+    bNeedsPack = true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::clear(){
+    for(size_t i = 0; i < entries.size(); i++) deleteEntry(entries[i]);
+    entries.clear();
+    vertices.clear();
+    texCoords.clear();
+    sharedTexCoords.clear();
+    indices.clear();
+    bNeedsPack = true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::deleteEntry(Entry & entry){
+    delete entry.warp;
+    delete entry.lut;
+    delete entry.mask;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpManager::getNumWarps(){
+    return entries.size();
+}
+
+//--------------------------------------------------------------
+ofxBezierWarp& ofxBezierWarpManager::getWarp(int index){
+    return *entries[index].warp;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::setOutputRect(int index, ofRectangle rect){
+    if(index < 0 || index >= (int)entries.size()) return;
+    entries[index].outputRect = rect;
+    // so picking control points works where the warp is drawn
+    entries[index].warp->setWarpGridPosition(rect.x, rect.y, rect.width, rect.height);
+    entries[index].bLUTDirty = true;
+    bNeedsPack = true;
+}
+
+//--------------------------------------------------------------
+ofRectangle ofxBezierWarpManager::getOutputRect(int index){
+    return entries[index].outputRect;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::setSourceRect(int index, ofRectangle rect){
+    if(index < 0 || index >= (int)entries.size()) return;
+    entries[index].sourceRect = rect;
+    entries[index].bSourceRect = true;
+    entries[index].bLUTDirty = true;
+    bNeedsPack = true;
+}
+
+//--------------------------------------------------------------
+ofRectangle ofxBezierWarpManager::getSourceRect(int index){
+    return entries[index].sourceRect;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMask& ofxBezierWarpManager::getMask(int index){
+    return *entries[index].mask;
+}
+
+//--------------------------------------------------------------
+const unsigned char * ofxBezierWarpManager::updateMask(Entry & entry){
+    
+    if(!entry.mask->isEnabled()) return NULL;
+    
+    int width = (int)(entry.outputRect.width + 0.5f);
+    int height = (int)(entry.outputRect.height + 0.5f);
+    
+    entry.mask->update(entry.warp->getMesh(), entry.warp->getWidth(), entry.warp->getHeight(), width, height, &remapper.getThreadPool());
+    
+    return entry.mask->getData();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::drawMasks(){
+    for(size_t i = 0; i < entries.size(); i++){
+        Entry & entry = entries[i];
+        if(updateMask(entry) == NULL) continue;
+        entry.mask->draw(entry.outputRect.x, entry.outputRect.y, entry.outputRect.width, entry.outputRect.height);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::allocateSource(int w, int h, int internalFormat){
+    source.allocate(w, h, internalFormat);
+    source.begin();
+    glClearColor(0.0, 0.0, 0.0, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    source.end();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::beginSource(){
+    if(!source.isAllocated()){
+        ofLogError() << "Shared source isn't allocated - call allocateSource first";
+        return;
+    }
+    source.begin();
+    glClearColor(0.0, 0.0, 0.0, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::endSource(){
+    if(!source.isAllocated()) return;
+    source.end();
+}
+
+//--------------------------------------------------------------
+ofFbo& ofxBezierWarpManager::getSourceReference(){
+    return source;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::update(){
+    
+    // a new mesh (eg., from the background thread) or one with a
+    // different number of vertices means moving everything around
+    for(size_t i = 0; i < entries.size(); i++){
+        Entry & entry = entries[i];
+        ofxBezierWarpMesh * mesh = &entry.warp->getMesh();
+        if(mesh != entry.mesh || mesh->getNumVertices() != entry.numVertices || mesh->getNumIndices() != entry.numIndices){
+            entry.mesh = mesh;
+            bNeedsPack = true;
+        }
+    }
+    
+    if(bNeedsPack){
+        pack();
+        return;
+    }
+    
+    for(size_t i = 0; i < entries.size(); i++){
+        Entry & entry = entries[i];
+        if(entry.mesh->getVersion() != entry.meshVersion){
+            // adaptive meshes can change shape without changing size and
+            // so can a grid that's gone from eg., 10 x 20 to 20 x 10
+            bool bTopology = entry.mesh->getAdaptive() || entry.mesh->getGridDivisionsX() != entry.gridDivX ||
+                             entry.mesh->getGridDivisionsY() != entry.gridDivY;
+            refresh(entry, bTopology);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::pack(){
+    
+    int numVertices = 0;
+    int numIndices = 0;
+    
+    for(size_t i = 0; i < entries.size(); i++){
+        Entry & entry = entries[i];
+        entry.vertexOffset = numVertices;
+        entry.indexOffset = numIndices;
+        entry.numVertices = entry.mesh->getNumVertices();
+        entry.numIndices = entry.mesh->getNumIndices();
+        numVertices += entry.numVertices;
+        numIndices += entry.numIndices;
+    }
+    
+    vertices.resize(numVertices * 3);
+    texCoords.resize(numVertices * 2);
+    sharedTexCoords.resize(numVertices * 2);
+    indices.resize(numIndices);
+    
+    for(size_t i = 0; i < entries.size(); i++) refresh(entries[i], true);
+    
+    bNeedsPack = false;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::refresh(Entry & entry, bool bTopology){
+    
+    ofxBezierWarpMesh & mesh = *entry.mesh;
+    entry.meshVersion = mesh.getVersion();
+    
+    if(entry.numVertices == 0) return;
+    
+    float width = entry.warp->getWidth();
+    float height = entry.warp->getHeight();
+    
+    // place the vertices at the output like draw(x, y, w, h) does
+    float scaleX = entry.outputRect.width / width;
+    float scaleY = entry.outputRect.height / height;
+    
+    const GLfloat * src = &mesh.getVerticesReference()[0];
+    GLfloat * dst = &vertices[entry.vertexOffset * 3];
+    
+    for(int i = 0; i < entry.numVertices; i++){
+        dst[i*3+0] = entry.outputRect.x + src[i*3+0] * scaleX;
+        dst[i*3+1] = entry.outputRect.y + src[i*3+1] * scaleY;
+        dst[i*3+2] = src[i*3+2];
+    }
+    
+    if(!bTopology) return;
+    
+    entry.gridDivX = mesh.getGridDivisionsX();
+    entry.gridDivY = mesh.getGridDivisionsY();
+    
+    // texture coordinates in pixels of the warp's own fbo and of
+    // its region of the shared source - beginDraw() scales them
+    const GLfloat * tc = &mesh.getTexCoordsReference()[0];
+    GLfloat * own = &texCoords[entry.vertexOffset * 2];
+    GLfloat * shared = &sharedTexCoords[entry.vertexOffset * 2];
+    
+    ofRectangle sourceRect = entry.bSourceRect ? entry.sourceRect : ofRectangle(0, 0, width, height);
+    
+    for(int i = 0; i < entry.numVertices; i++){
+        own[i*2+0] = tc[i*2+0] * width;
+        own[i*2+1] = tc[i*2+1] * height;
+        shared[i*2+0] = sourceRect.x + tc[i*2+0] * sourceRect.width;
+        shared[i*2+1] = sourceRect.y + tc[i*2+1] * sourceRect.height;
+    }
+    
+    const GLuint * index = &mesh.getIndicesReference()[0];
+    GLuint * out = &indices[entry.indexOffset];
+    
+    for(int i = 0; i < entry.numIndices; i++) out[i] = index[i] + entry.vertexOffset;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::beginDraw(ofTexture & texture){
+    
+    texture.bind();
+    
+    // pixels to whatever the texture target wants (rect or 2D)
+    ofPoint scale = texture.getCoordFromPoint(texture.getWidth(), texture.getHeight());
+    
+    glMatrixMode(GL_TEXTURE);
+    glPushMatrix();
+    glLoadIdentity();
+    glScalef(scale.x / texture.getWidth(), scale.y / texture.getHeight(), 1.0f);
+    glMatrixMode(GL_MODELVIEW);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::endDraw(){
+    glMatrixMode(GL_TEXTURE);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::draw(){
+    if(source.isAllocated()){
+        draw(source.getTextureReference());
+    }else{
+        drawOwn();
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::drawOwn(){
+    
+    update();
+    
+    if(indices.size() == 0) return;
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    
+    glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+    glTexCoordPointer(2, GL_FLOAT, 0, &texCoords[0]);
+    
+    for(size_t i = 0; i < entries.size(); i++){
+        
+        Entry & entry = entries[i];
+        
+        if(entry.numIndices == 0 || !entry.warp->getFBO().isAllocated()) continue;
+        
+        ofTexture & texture = entry.warp->getTextureReference();
+        
+        if(!entry.warp->getDoWarp()){
+            // this sets its own pointers so put ours back afterwards
+            texture.draw(entry.outputRect.x, entry.outputRect.y, entry.outputRect.width, entry.outputRect.height);
+            glEnableClientState(GL_VERTEX_ARRAY);
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+            glTexCoordPointer(2, GL_FLOAT, 0, &texCoords[0]);
+            continue;
+        }
+        
+        beginDraw(texture);
+        glDrawElements(GL_TRIANGLES, entry.numIndices, GL_UNSIGNED_INT, &indices[entry.indexOffset]);
+        texture.unbind();
+        endDraw();
+    }
+    
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    
+    drawMasks();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::draw(ofTexture & source){
+    
+    update();
+    
+    if(indices.size() == 0) return;
+    
+    beginDraw(source);
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    
+    glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+    glTexCoordPointer(2, GL_FLOAT, 0, &sharedTexCoords[0]);
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, &indices[0]);
+    
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    
+    source.unbind();
+    endDraw();
+    
+    drawMasks();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::drawWarpGrids(){
+    for(size_t i = 0; i < entries.size(); i++){
+        if(entries[i].warp->getShowWarpGrid()) entries[i].warp->drawWarpGrid();
+    }
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpManager::getNumVertices(){
+    return vertices.size() / 3;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpManager::getNumIndices(){
+    return indices.size();
+}
+
+//--------------------------------------------------------------
+vector<GLfloat>& ofxBezierWarpManager::getVerticesReference(){
+    return vertices;
+}
+
+//--------------------------------------------------------------
+vector<GLfloat>& ofxBezierWarpManager::getTexCoordsReference(){
+    return texCoords;
+}
+
+//--------------------------------------------------------------
+vector<GLuint>& ofxBezierWarpManager::getIndicesReference(){
+    return indices;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpManager::updateLUT(Entry & entry, const ofPixels & source){
+    
+    ofxBezierWarpMesh & mesh = entry.warp->getMesh();
+    int width = (int)(entry.outputRect.width + 0.5f);
+    int height = (int)(entry.outputRect.height + 0.5f);
+    
+    if(width <= 0 || height <= 0 || !mesh.isAllocated()) return false;
+    
+    ofxBezierWarpLUT & lut = *entry.lut;
+    ofxBezierWarpLUT & settings = remapper.getLUT();
+    
+    // compare against the bits a build would actually end up using
+    int fractionBits = ofxBezierWarpLUT::getEffectiveFractionBits(settings.getFormat(), settings.getFractionBits(),
+                                                                  source.getWidth(), source.getHeight());
+    
+    if(!entry.bLUTDirty && lut.isAllocated() && entry.lutMesh == &mesh && entry.lutMeshVersion == mesh.getVersion() &&
+       lut.getWidth() == width && lut.getHeight() == height &&
+       lut.getSourceWidth() == source.getWidth() && lut.getSourceHeight() == source.getHeight() &&
+       lut.getFormat() == settings.getFormat() && lut.getFractionBits() == fractionBits) return true;
+    
+    entry.lutMesh = &mesh;
+    entry.lutMeshVersion = mesh.getVersion();
+    entry.bLUTDirty = false;
+    
+    lut.setFormat(settings.getFormat(), settings.getFractionBits());
+    remapper.buildLUT(lut, mesh, entry.warp->getWidth(), entry.warp->getHeight(), entry.sourceRect,
+                      source.getWidth(), source.getHeight(), width, height);
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::remap(const ofPixels & source, ofPixels & output){
+    
+    if(!source.isAllocated()) return;
+    
+    int numChannels = source.getNumChannels();
+    
+    if(!output.isAllocated() || output.getNumChannels() != numChannels){
+        int width = 0, height = 0;
+        for(size_t i = 0; i < entries.size(); i++){
+            width = MAX(width, (int)(entries[i].outputRect.x + entries[i].outputRect.width + 0.5f));
+            height = MAX(height, (int)(entries[i].outputRect.y + entries[i].outputRect.height + 0.5f));
+        }
+        if(width <= 0 || height <= 0) return;
+        output.allocate(width, height, numChannels);
+        memset(output.getPixels(), 0, width * height * numChannels);
+    }
+    
+    for(size_t i = 0; i < entries.size(); i++){
+        
+        Entry & entry = entries[i];
+        
+        if(!updateLUT(entry, source)) continue;
+        
+        int x = (int)(entry.outputRect.x + 0.5f);
+        int y = (int)(entry.outputRect.y + 0.5f);
+        
+        if(x < 0 || y < 0 || x + entry.lut->getWidth() > output.getWidth() || y + entry.lut->getHeight() > output.getHeight()){
+            ofLogError() << "Output rect of warp " << i << " doesn't fit in the remap output";
+            continue;
+        }
+        
+        // gathers straight into its part of the output
+        unsigned char * dst = output.getPixels() + (y * output.getWidth() + x) * numChannels;
+        remapper.remap(*entry.lut, source.getPixels(), dst, numChannels, output.getWidth(), updateMask(entry));
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpManager::remap(int index, const ofPixels & source, ofPixels & output){
+    
+    if(index < 0 || index >= (int)entries.size() || !source.isAllocated()) return;
+    
+    Entry & entry = entries[index];
+    
+    if(!updateLUT(entry, source)) return;
+    
+    if(!output.isAllocated() || output.getWidth() != entry.lut->getWidth() || output.getHeight() != entry.lut->getHeight() ||
+       output.getNumChannels() != source.getNumChannels()){
+        output.allocate(entry.lut->getWidth(), entry.lut->getHeight(), source.getNumChannels());
+    }
+    
+    remapper.remap(*entry.lut, source.getPixels(), output.getPixels(), source.getNumChannels(), 0, updateMask(entry));
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpRemap& ofxBezierWarpManager::getRemap(){
+    return remapper;
+}
@@ -0,0 +1,161 @@
+/*
+ * ofxBezierWarpManager.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#ifndef _H_OFXBEZIERWARPMANAGER
+#define _H_OFXBEZIERWARPMANAGER
+
+#include "ofxBezierWarp.h"
+#include "ofxBezierWarpRemap.h"
+
+// owns a set of warps (eg., one per projector) and packs all their meshes
+// into one shared vertex/index arena already placed at their outputs, so
+// drawing every output from a shared source texture is a single draw call
+// - and drawing each from its own fbo only costs a bind per warp. Warps
+// only get copied back into the arena when their mesh actually changes
+//
+// with a shared source the scene only gets rendered once (between
+// beginSource() and endSource()) and each warp shows its own region of it,
+// either on the GPU with draw() or on the CPU with remap()
+
+class ofxBezierWarpManager {
+    
+public:
+	
+    ofxBezierWarpManager();
+    ~ofxBezierWarpManager();
+    
+    // bAllocateFbo false is for when everything is drawn from a shared source
+    ofxBezierWarp& addWarp(int w, int h, int numXPoints, int numYPoints, float pixelsPerGridDivision, bool bAllocateFbo = true);
+    void removeWarp(int index);
+    void clear();
+    
+    int getNumWarps();
+    ofxBezierWarp& getWarp(int index);
+    
+    // where the warp ends up on screen (defaults to 0, 0, w, h)
+    void setOutputRect(int index, ofRectangle rect);
+    ofRectangle getOutputRect(int index);
+    
+    // which part of the shared source texture the warp shows (in pixels)
+    void setSourceRect(int index, ofRectangle rect);
+    ofRectangle getSourceRect(int index);
+    
+    // edge blend and brightness compensation for one warp - built at its
+    // output rect size and applied by both draw() and remap()
+    ofxBezierWarpMask& getMask(int index);
+    
+    // the shared source everything is rendered into once
+    void allocateSource(int w, int h, int internalFormat = GL_RGBA);
+    void beginSource();
+    void endSource();
+    ofFbo& getSourceReference();
+    
+    // refreshes the arena - called by draw() too
+    void update();
+    
+    // every warp from the shared source if it's allocated, otherwise
+    // every warp from its own fbo
+    void draw();
+    
+    // every warp from regions of one texture in one go
+    void draw(ofTexture & source);
+    
+    void drawWarpGrids();
+    
+    // every warp from its region of one image into output at its output
+    // rect - output is allocated to fit them all if it isn't already and
+    // anything outside the output rects is left alone (like draw)
+    void remap(const ofPixels & source, ofPixels & output);
+    
+    // just one warp, output is allocated at its output rect size
+    void remap(int index, const ofPixels & source, ofPixels & output);
+    
+    // threads, kernel and LUT format (of getLUT()) used for every warp
+    ofxBezierWarpRemap& getRemap();
+    
+    int getNumVertices();
+    int getNumIndices();
+    
+    vector<GLfloat>& getVerticesReference();
+    vector<GLfloat>& getTexCoordsReference();
+    vector<GLuint>& getIndicesReference();
+    
+protected:
+	
+    struct Entry {
+        ofxBezierWarp * warp;
+        ofRectangle outputRect;
+        ofRectangle sourceRect;
+        bool bSourceRect;
+        ofxBezierWarpMesh * mesh;
+        unsigned int meshVersion;
+        int gridDivX;       // the layout the texcoords and indices were copied for
+        int gridDivY;
+        int vertexOffset;
+        int numVertices;
+        int indexOffset;
+        int numIndices;
+        ofxBezierWarpLUT * lut;
+        ofxBezierWarpMask * mask;
+        ofxBezierWarpMesh * lutMesh;
+        unsigned int lutMeshVersion;
+        bool bLUTDirty;
+    };
+    
+    void pack();
+    void refresh(Entry & entry, bool bShared);
+    void beginDraw(ofTexture & texture);
+    void endDraw();
+    void drawOwn();
+    void drawMasks();
+    const unsigned char * updateMask(Entry & entry);
+    bool updateLUT(Entry & entry, const ofPixels & source);
+    
+    void deleteEntry(Entry & entry);
+    
+    vector<Entry> entries;
+    
+    vector<GLfloat> vertices;
+    vector<GLfloat> texCoords;
+    vector<GLfloat> sharedTexCoords;
+    vector<GLuint> indices;
+    
+    bool bNeedsPack;
+    
+    ofFbo source;
+    ofxBezierWarpRemap remapper;
+    
+private:
+	
+};
+
+#endif
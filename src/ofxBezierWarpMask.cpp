@@ -0,0 +1,493 @@
+/*
+ * ofxBezierWarpMask.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpMask.h"
+#include "ofxBezierWarpRasterizer.h"
+#include "ofxBezierWarpSIMD.h"
+
+static const int rampSize = 1024;
+
+//--------------------------------------------------------------
+ofxBezierWarpMask::ofxBezierWarpMask(){
+    blendLeft = blendRight = blendTop = blendBottom = 0.0f;
+    blendPower = 2.0f;
+    blendGamma = 2.2f;
+    compensation = 0.0f;
+    bDirty = true;
+    bTextureDirty = true;
+    builtMesh = NULL;
+    builtMeshVersion = 0;
+    width = 0;
+    height = 0;
+    areaDivisions = 32;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMask::~ofxBezierWarpMask(){
+    
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::setBlend(float left, float right, float top, float bottom){
+    blendLeft = ofClamp(left, 0.0f, 1.0f);
+    blendRight = ofClamp(right, 0.0f, 1.0f);
+    blendTop = ofClamp(top, 0.0f, 1.0f);
+    blendBottom = ofClamp(bottom, 0.0f, 1.0f);
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getBlendLeft(){
+    return blendLeft;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getBlendRight(){
+    return blendRight;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getBlendTop(){
+    return blendTop;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getBlendBottom(){
+    return blendBottom;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::setBlendCurve(float power, float gamma){
+    blendPower = MAX(power, 0.01f);
+    blendGamma = MAX(gamma, 0.01f);
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getBlendPower(){
+    return blendPower;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getBlendGamma(){
+    return blendGamma;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::setCompensation(float strength){
+    compensation = ofClamp(strength, 0.0f, 1.0f);
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getCompensation(){
+    return compensation;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMask::isEnabled(){
+    return blendLeft > 0.0f || blendRight > 0.0f || blendTop > 0.0f || blendBottom > 0.0f || compensation > 0.0f;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMask::update(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, int _width, int _height,
+                               ofxBezierWarpThreadPool * pool){
+    
+    if(!bDirty && data.size() > 0 && builtMesh == &mesh && builtMeshVersion == mesh.getVersion() &&
+       width == _width && height == _height) return false;
+    
+    if(!mesh.isAllocated() || meshWidth <= 0 || meshHeight <= 0 || _width <= 0 || _height <= 0) return false;
+    
+    builtMesh = &mesh;
+    builtMeshVersion = mesh.getVersion();
+    width = _width;
+    height = _height;
+    bDirty = false;
+    bTextureDirty = true;
+    
+    data.resize(width * height);
+    
+    BuildJob job;
+    job.mask = this;
+    job.mesh = &mesh;
+    job.scaleX = width / meshWidth;
+    job.scaleY = height / meshHeight;
+    job.width = width;
+    job.height = height;
+    
+    buildRamp();
+    buildArea(mesh, job.scaleX, job.scaleY);
+    
+    int numBands = MIN(height, (pool != NULL ? pool->getNumThreads() : 1) * 4);
+    job.bandHeight = (height + numBands - 1) / numBands;
+    numBands = (height + job.bandHeight - 1) / job.bandHeight;
+    
+    if(pool != NULL){
+        pool->run(job, numBands);
+    }else{
+        for(int i = 0; i < numBands; i++) job.process(i);
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::buildRamp(){
+    
+    // paul bourke's edge blend curve: t is 0 at the edge of the content
+    // and 1 where the ramp ends, then it's gamma corrected for the projector
+    
+    ramp.resize(rampSize + 1);
+    
+    for(int i = 0; i <= rampSize; i++){
+        float t = (float)i / rampSize;
+        float f = t < 0.5f ? 0.5f * powf(2.0f * t, blendPower) : 1.0f - 0.5f * powf(2.0f * (1.0f - t), blendPower);
+        ramp[i] = powf(f, 1.0f / blendGamma);
+    }
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getRamp(float t){
+    if(t >= 1.0f) return 1.0f;
+    if(t <= 0.0f) return 0.0f;
+    return ramp[(int)(t * rampSize + 0.5f)];
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::buildArea(ofxBezierWarpMesh & mesh, float scaleX, float scaleY){
+    
+    int n = areaDivisions + 1;
+    area.assign(n * n, 1.0f);
+    
+    if(compensation <= 0.0f) return;
+    
+    // surface positions on the lattice in output pixels
+    vector<float> positions(n * n * 2);
+    
+    for(int j = 0; j < n; j++){
+        for(int i = 0; i < n; i++){
+            GLfloat p[3];
+            ofxBezierWarpMesh::evaluate(mesh.getControlPointsReference(), mesh.getNumXPoints(), mesh.getNumYPoints(),
+                                        (float)i / areaDivisions, (float)j / areaDivisions, p, mesh.getMode());
+            mesh.getLatticeReference().addDisplacement((float)i / areaDivisions, (float)j / areaDivisions, p);
+            positions[(j * n + i) * 2 + 0] = p[0] * scaleX;
+            positions[(j * n + i) * 2 + 1] = p[1] * scaleY;
+        }
+    }
+    
+    // output pixels per unit of content (the jacobian's determinant) from
+    // differences across neighbouring lattice points
+    
+    float maxArea = 0.0f;
+    
+    for(int j = 0; j < n; j++){
+        int j0 = MAX(j - 1, 0), j1 = MIN(j + 1, n - 1);
+        for(int i = 0; i < n; i++){
+            int i0 = MAX(i - 1, 0), i1 = MIN(i + 1, n - 1);
+            const float * l = &positions[(j * n + i0) * 2];
+            const float * r = &positions[(j * n + i1) * 2];
+            const float * t = &positions[(j0 * n + i) * 2];
+            const float * b = &positions[(j1 * n + i) * 2];
+            float dux = (r[0] - l[0]) / (i1 - i0), duy = (r[1] - l[1]) / (i1 - i0);
+            float dvx = (b[0] - t[0]) / (j1 - j0), dvy = (b[1] - t[1]) / (j1 - j0);
+            area[j * n + i] = fabsf(dux * dvy - duy * dvx);
+            maxArea = MAX(maxArea, area[j * n + i]);
+        }
+    }
+    
+    // everything gets dimmed to match the most squeezed part - but
+    // not down to where the surface has collapsed to nothing
+    
+    float minArea = maxArea;
+    for(int k = 0; k < n * n; k++){
+        if(area[k] > maxArea * 0.001f) minArea = MIN(minArea, area[k]);
+    }
+    
+    for(int k = 0; k < n * n; k++){
+        area[k] = area[k] > minArea ? powf(minArea / area[k], compensation) : 1.0f;
+    }
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getArea(float u, float v){
+    
+    int n = areaDivisions + 1;
+    
+    float x = ofClamp(u, 0.0f, 1.0f) * areaDivisions;
+    float y = ofClamp(v, 0.0f, 1.0f) * areaDivisions;
+    int i = MIN((int)x, areaDivisions - 1);
+    int j = MIN((int)y, areaDivisions - 1);
+    float fx = x - i, fy = y - j;
+    
+    const float * a = &area[j * n + i];
+    float top = a[0] + (a[1] - a[0]) * fx;
+    float bottom = a[n] + (a[n + 1] - a[n]) * fx;
+    
+    return top + (bottom - top) * fy;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMask::getValue(float u, float v){
+    
+    float value = getArea(u, v);
+    
+    if(blendLeft > 0.0f) value *= getRamp(u / blendLeft);
+    if(blendRight > 0.0f) value *= getRamp((1.0f - u) / blendRight);
+    if(blendTop > 0.0f) value *= getRamp(v / blendTop);
+    if(blendBottom > 0.0f) value *= getRamp((1.0f - v) / blendBottom);
+    
+    return value;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::buildRow(const float * coords, unsigned char * row, int count){
+    
+    int x = 0;
+    
+#if defined(OFX_BEZIER_WARP_SSE)
+    // same steps as getValue four pixels at a time - only the area and
+    // ramp table reads are left scalar (there's no gather before AVX2)
+    
+    int n = areaDivisions + 1;
+    float blends[4] = {blendLeft, blendRight, blendTop, blendBottom};
+    
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 divisions = _mm_set1_ps((float)areaDivisions);
+    __m128 lastCell = _mm_set1_ps((float)(areaDivisions - 1));
+    __m128 size = _mm_set1_ps((float)rampSize);
+    __m128 scale = _mm_set1_ps(255.0f);
+    
+    int i[4], j[4], r[4];
+    float a00[4], a10[4], a01[4], a11[4], t[4];
+    
+    for(; x + 4 <= count; x += 4){
+        
+        __m128 lo = _mm_loadu_ps(coords + x * 2);
+        __m128 hi = _mm_loadu_ps(coords + x * 2 + 4);
+        __m128 u = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 v = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 covered = _mm_cmpge_ps(u, zero);
+        
+        // bilinear across the area lattice
+        __m128 ax = _mm_mul_ps(_mm_min_ps(_mm_max_ps(u, zero), one), divisions);
+        __m128 ay = _mm_mul_ps(_mm_min_ps(_mm_max_ps(v, zero), one), divisions);
+        __m128i ci = _mm_cvttps_epi32(_mm_min_ps(ax, lastCell));
+        __m128i cj = _mm_cvttps_epi32(_mm_min_ps(ay, lastCell));
+        __m128 fx = _mm_sub_ps(ax, _mm_cvtepi32_ps(ci));
+        __m128 fy = _mm_sub_ps(ay, _mm_cvtepi32_ps(cj));
+        
+        _mm_storeu_si128((__m128i *)i, ci);
+        _mm_storeu_si128((__m128i *)j, cj);
+        for(int k = 0; k < 4; k++){
+            const float * a = &area[j[k] * n + i[k]];
+            a00[k] = a[0];
+            a10[k] = a[1];
+            a01[k] = a[n];
+            a11[k] = a[n + 1];
+        }
+        
+        __m128 top = _mm_loadu_ps(a00);
+        __m128 bottom = _mm_loadu_ps(a01);
+        top = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(a10), top), fx));
+        bottom = _mm_add_ps(bottom, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(a11), bottom), fx));
+        __m128 value = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fy));
+        
+        // left, right, top, bottom ramps in the same order as getValue
+        for(int e = 0; e < 4; e++){
+            
+            if(blends[e] <= 0.0f) continue;
+            
+            __m128 s = e < 2 ? u : v;
+            if(e & 1) s = _mm_sub_ps(one, s);
+            s = _mm_div_ps(s, _mm_set1_ps(blends[e]));
+            
+            __m128 st = _mm_min_ps(_mm_max_ps(s, zero), one);
+            _mm_storeu_si128((__m128i *)r, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(st, size), half)));
+            for(int k = 0; k < 4; k++) t[k] = ramp[r[k]];
+            
+            // 0 at or before the edge and 1 past the end like getRamp
+            __m128 past = _mm_cmpge_ps(s, one);
+            __m128 ramped = _mm_andnot_ps(_mm_cmple_ps(s, zero), _mm_loadu_ps(t));
+            ramped = _mm_or_ps(_mm_andnot_ps(past, ramped), _mm_and_ps(past, one));
+            value = _mm_mul_ps(value, ramped);
+        }
+        
+        value = _mm_min_ps(_mm_max_ps(value, zero), one);
+        __m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+        q = _mm_and_si128(q, _mm_castps_si128(covered));
+        q = _mm_packs_epi32(q, q);
+        ofxBezierWarpStorePixel(row + x, _mm_cvtsi128_si32(_mm_packus_epi16(q, q)));
+    }
+#endif
+    
+    for(; x < count; x++){
+        float u = coords[x * 2 + 0];
+        float v = coords[x * 2 + 1];
+        row[x] = u < 0.0f ? 0 : (unsigned char)(ofClamp(getValue(u, v), 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::BuildJob::process(int band){
+    
+    int bandBegin = band * bandHeight;
+    int bandEnd = MIN(bandBegin + bandHeight, height);
+    
+    // the mesh is rasterized a few rows at a time into texture coords and
+    // each row is turned into mask values in one go. u stays negative where
+    // the mesh doesn't reach and those pixels are black
+    
+    int chunkHeight = 32;
+    vector<float> chunkCoords(MIN(chunkHeight, bandEnd - bandBegin) * width * 2);
+    
+    // a copy so each band writes into its own coords
+    BuildJob rows = *this;
+    rows.coords = &chunkCoords[0];
+    
+    for(int y = bandBegin; y < bandEnd; y += chunkHeight){
+        int chunkEnd = MIN(y + chunkHeight, bandEnd);
+        std::fill(chunkCoords.begin(), chunkCoords.begin() + (chunkEnd - y) * width * 2, -1.0f);
+        rows.coordsBegin = y;
+        ofxBezierWarpRasterizeMesh(*mesh, scaleX, scaleY, width, y, chunkEnd, rows);
+        for(int k = y; k < chunkEnd; k++){
+            mask->buildRow(&chunkCoords[(k - y) * width * 2], &mask->data[k * width], width);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::BuildJob::operator()(int x, int y, float u, float v){
+    coords[((y - coordsBegin) * width + x) * 2 + 0] = u;
+    coords[((y - coordsBegin) * width + x) * 2 + 1] = v;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::apply(unsigned char * pixels, const unsigned char * mask, int count, int numChannels){
+    
+    // p * m / 255 rounded - (v + (v >> 8)) >> 8 is exact for v = p * m + 128
+    
+    int k = 0;
+    
+#if defined(OFX_BEZIER_WARP_SSE)
+    if(numChannels == 4){
+        __m128i zero = _mm_setzero_si128();
+        __m128i alpha = _mm_set1_epi32(0xFF000000);
+        __m128i round = _mm_set1_epi16(128);
+        for(; k + 4 <= count; k += 4){
+            // m0 m0 m0 255 m1 m1 m1 255...
+            __m128i m = _mm_cvtsi32_si128(ofxBezierWarpLoadPixel(mask + k));
+            m = _mm_unpacklo_epi8(m, m);
+            m = _mm_or_si128(_mm_unpacklo_epi16(m, m), alpha);
+            __m128i p = _mm_loadu_si128((const __m128i *)(pixels + k * 4));
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), _mm_unpacklo_epi8(m, zero)), round);
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), _mm_unpackhi_epi8(m, zero)), round);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            _mm_storeu_si128((__m128i *)(pixels + k * 4), _mm_packus_epi16(lo, hi));
+        }
+    }
+#endif
+    
+    int numColors = numChannels == 4 ? 3 : (numChannels == 2 ? 1 : numChannels);
+    
+    for(; k < count; k++){
+        unsigned char * p = pixels + k * numChannels;
+        for(int c = 0; c < numColors; c++){
+            int v = p[c] * mask[k] + 128;
+            p[c] = (v + (v >> 8)) >> 8;
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::draw(float x, float y, float w, float h){
+    
+    if(data.size() == 0) return;
+    
+    if(bTextureDirty){
+        if(!texture.bAllocated() || texture.getWidth() != width || texture.getHeight() != height){
+            texture.allocate(width, height, GL_LUMINANCE);
+        }
+        texture.loadData(&data[0], width, height, GL_LUMINANCE);
+        bTextureDirty = false;
+    }
+    
+    // luminance comes out as (m, m, m, 1) so alpha is left alone
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ZERO, GL_SRC_COLOR);
+    texture.draw(x, y, w, h);
+    glPopAttrib();
+}
+
+//--------------------------------------------------------------
+ofTexture& ofxBezierWarpMask::getTextureReference(){
+    return texture;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMask::clear(){
+    data.clear();
+    area.clear();
+    width = height = 0;
+    builtMesh = NULL;
+    bDirty = true;
+    bTextureDirty = true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMask::isAllocated(){
+    return data.size() > 0;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMask::getWidth(){
+    return width;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMask::getHeight(){
+    return height;
+}
+
+//--------------------------------------------------------------
+unsigned char * ofxBezierWarpMask::getData(){
+    return data.size() > 0 ? &data[0] : NULL;
+}
+
+//--------------------------------------------------------------
+vector<unsigned char>& ofxBezierWarpMask::getDataReference(){
+    return data;
+}
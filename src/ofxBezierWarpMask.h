@@ -0,0 +1,148 @@
+/*
+ * ofxBezierWarpMask.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#ifndef _H_OFXBEZIERWARPMASK
+#define _H_OFXBEZIERWARPMASK
+
+#include "ofTexture.h"
+#include "ofxBezierWarpMesh.h"
+#include "ofxBezierWarpThreadPool.h"
+
+// per output pixel brightness mask for a warp: soft edge blend ramps for
+// overlapping projectors times a compensation for where the surface
+// spreads the content over more pixels than elsewhere (and so looks
+// brighter). It's only rebuilt when the mesh, size or settings change -
+// the remap multiplies it in while gathering and draw() lays it over GL output
+
+class ofxBezierWarpMask {
+    
+public:
+	
+    ofxBezierWarpMask();
+    ~ofxBezierWarpMask();
+    
+    // ramp widths as a fraction of the content (0 is no ramp on that edge)
+    void setBlend(float left, float right, float top, float bottom);
+    float getBlendLeft();
+    float getBlendRight();
+    float getBlendTop();
+    float getBlendBottom();
+    
+    // power shapes the ramp (1 is linear) and gamma is the projector's
+    void setBlendCurve(float power = 2.0f, float gamma = 2.2f);
+    float getBlendPower();
+    float getBlendGamma();
+    
+    // 0 is off, 1 evens brightness out to the most squeezed part of the warp
+    void setCompensation(float strength);
+    float getCompensation();
+    
+    // false while the mask would be white everywhere the mesh covers
+    bool isEnabled();
+    
+    // returns true if the mask had to be rebuilt
+    bool update(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, int width, int height,
+                ofxBezierWarpThreadPool * pool = NULL);
+    
+    void clear();
+    bool isAllocated();
+    
+    int getWidth();
+    int getHeight();
+    
+    // one byte per pixel, 255 leaves the pixel alone
+    unsigned char * getData();
+    vector<unsigned char>& getDataReference();
+    
+    // multiplies whatever is already drawn at x, y, w, h by the mask
+    void draw(float x, float y, float w, float h);
+    ofTexture& getTextureReference();
+    
+    // scales the colour channels of count pixels by the mask (alpha is left alone)
+    static void apply(unsigned char * pixels, const unsigned char * mask, int count, int numChannels);
+    
+protected:
+	
+    void buildRamp();
+    void buildArea(ofxBezierWarpMesh & mesh, float scaleX, float scaleY);
+    float getRamp(float t);
+    float getArea(float u, float v);
+    float getValue(float u, float v);
+    void buildRow(const float * coords, unsigned char * row, int count);
+    
+    class BuildJob : public ofxBezierWarpJob {
+    public:
+        void process(int band);
+        void operator()(int x, int y, float u, float v);
+        float * coords;     // u, v per pixel of the rows being rasterized
+        int coordsBegin;
+        ofxBezierWarpMask * mask;
+        ofxBezierWarpMesh * mesh;
+        float scaleX;
+        float scaleY;
+        int width;
+        int height;
+        int bandHeight;
+    };
+    
+    float blendLeft;
+    float blendRight;
+    float blendTop;
+    float blendBottom;
+    float blendPower;
+    float blendGamma;
+    float compensation;
+    
+    bool bDirty;
+    bool bTextureDirty;
+    
+    ofxBezierWarpMesh * builtMesh;
+    unsigned int builtMeshVersion;
+    
+    int width;
+    int height;
+    
+    vector<unsigned char> data;
+    vector<float> ramp;
+    
+    // compensation sampled on an areaDivisions x areaDivisions lattice
+    // over the content and interpolated per pixel - it's smooth anyway
+    int areaDivisions;
+    vector<float> area;
+    
+    ofTexture texture;
+    
+private:
+	
+};
+
+#endif
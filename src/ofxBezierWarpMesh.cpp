@@ -0,0 +1,1227 @@
+/*
+ * ofxBezierWarpMesh.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpMesh.h"
+#include "ofxBezierWarpSIMD.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpMesh::ofxBezierWarpMesh(){
+    numXPoints = 0;
+    numYPoints = 0;
+    gridDivX = 0;
+    gridDivY = 0;
+    mode = OFX_BEZIER_WARP_BEZIER;
+    bUseSIMD = true;
+    bUseFixedEvaluators = true;
+    gridEvaluator = NULL;
+    pointEvaluator = NULL;
+    bAdaptive = false;
+    bBuiltAdaptive = false;
+    tolerance = 0.5f;
+    builtTolerance = 0.5f;
+    stamp = 0;
+    version = 0;
+    indexOutput = OFX_BEZIER_WARP_INDEX_TRIANGLES;
+    bUseShortIndices = true;
+    bUsePrimitiveRestart = true;
+    vertexCacheSize = 16;
+    bDrawIndicesDirty = true;
+    bDrawRestart = false;
+    drawPrimitive = GL_TRIANGLES;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMesh::~ofxBezierWarpMesh(){
+    clear();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::update(const vector<GLfloat>& _cntrlPoints, int _numXPoints, int _numYPoints, int _gridDivX, int _gridDivY, ofxBezierWarpMode _mode,
+                               const ofxBezierWarpLattice * _lattice){
+    
+    if(_numXPoints < 2 || _numYPoints < 2 || _gridDivX < 1 || _gridDivY < 1) return false;
+    if(_cntrlPoints.size() < (size_t)(_numXPoints * _numYPoints * 3)) return false;
+    
+    static const ofxBezierWarpLattice noLattice;
+    const ofxBezierWarpLattice & lattice = _lattice != NULL ? *_lattice : noLattice;
+    bool bLatticeChanged = lattice.getVersion() != cachedLattice.getVersion();
+    
+    bool bTopologyChanged = (_gridDivX != gridDivX || _gridDivY != gridDivY || bAdaptive != bBuiltAdaptive ||
+                             (bAdaptive && tolerance != builtTolerance));
+    bool bNetChanged = (_numXPoints != numXPoints || _numYPoints != numYPoints || _mode != mode ||
+                        cachedCntrlPoints.size() != _cntrlPoints.size());
+    
+    if(!bTopologyChanged && !bNetChanged && bAdaptive){
+        
+        // any change can move where the surface bends so start again
+        if(!bLatticeChanged && memcmp(&cachedCntrlPoints[0], &_cntrlPoints[0], _cntrlPoints.size() * sizeof(GLfloat)) == 0) return false;
+        
+        cachedCntrlPoints = _cntrlPoints;
+        cachedLattice = lattice;
+        
+        rebuildAdaptive();
+        version++;
+        
+        return true;
+    }
+    
+    if(!bTopologyChanged && !bNetChanged){
+        
+        // find the block of control points that actually moved - with the
+        // patch modes only the vertices those points support need updating
+        // (a single bezier surface is supported everywhere by every point)
+        
+        int minX = _numXPoints, minY = _numYPoints, maxX = -1, maxY = -1;
+        
+        for(int j = 0; j < _numYPoints; j++){
+            for(int i = 0; i < _numXPoints; i++){
+                int idx = (j*_numXPoints+i)*3;
+                if(memcmp(&cachedCntrlPoints[idx], &_cntrlPoints[idx], 3 * sizeof(GLfloat)) != 0){
+                    minX = MIN(minX, i); maxX = MAX(maxX, i);
+                    minY = MIN(minY, j); maxY = MAX(maxY, j);
+                }
+            }
+        }
+        
+        if(maxX == -1 && !bLatticeChanged) return false;
+        
+        // lattice edits only need what changed since last time adding on
+        // (anything the net moved gets the whole lattice again below)
+        if(bLatticeChanged){
+            if(lattice.isSameSetup(cachedLattice)){
+                latticeDifference.setDifference(lattice, cachedLattice);
+                latticeDifference.addDisplacement(&vertices[0], gridDivX, gridDivY, 0, gridDivX + 1, 0, gridDivY + 1);
+            }else{
+                minX = minY = 0;
+                maxX = _numXPoints - 1;
+                maxY = _numYPoints - 1;
+            }
+            cachedLattice = lattice;
+        }
+        
+        if(maxX != -1){
+            cachedCntrlPoints = _cntrlPoints;
+            rebuildVertices(minX, minY, maxX, maxY);
+        }
+        
+        version++;
+        
+        return true;
+    }
+    
+    numXPoints = _numXPoints;
+    numYPoints = _numYPoints;
+    gridDivX = _gridDivX;
+    gridDivY = _gridDivY;
+    mode = _mode;
+    cachedCntrlPoints = _cntrlPoints;
+    cachedLattice = lattice;
+    
+    if(bNetChanged){
+        gridEvaluator = mode == OFX_BEZIER_WARP_BEZIER ? ofxBezierWarpGetGridEvaluator(numXPoints, numYPoints) : NULL;
+        pointEvaluator = mode == OFX_BEZIER_WARP_BEZIER ? ofxBezierWarpGetPointEvaluator(numXPoints, numYPoints) : NULL;
+    }
+    
+    if(bAdaptive){
+        rebuildAdaptive();
+    }else{
+        if(bTopologyChanged) rebuildTopology();
+        rebuildVertices();
+    }
+    
+    bBuiltAdaptive = bAdaptive;
+    builtTolerance = tolerance;
+    version++;
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::clear(){
+    numXPoints = 0;
+    numYPoints = 0;
+    gridDivX = 0;
+    gridDivY = 0;
+    mode = OFX_BEZIER_WARP_BEZIER;
+    bBuiltAdaptive = false;
+    gridEvaluator = NULL;
+    pointEvaluator = NULL;
+    version++;
+    cachedCntrlPoints.clear();
+    cachedLattice = ofxBezierWarpLattice();
+    latticeDifference = ofxBezierWarpLattice();
+    cells.clear();
+    samples.clear();
+    sampleStamps.clear();
+    indexStamps.clear();
+    sampleIndices.clear();
+    basisX.clear();
+    basisY.clear();
+    planes.clear();
+    rowScratch.clear();
+    colScratch.clear();
+    vertices.clear();
+    texCoords.clear();
+    indices.clear();
+    lineIndices.clear();
+    drawIndices.clear();
+    drawShortIndices.clear();
+    bDrawIndicesDirty = true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::isBlendable(ofxBezierWarpMesh & other){
+    return isAllocated() && other.isAllocated() && !bBuiltAdaptive && !other.bBuiltAdaptive &&
+           numXPoints == other.numXPoints && numYPoints == other.numYPoints && mode == other.mode &&
+           gridDivX == other.gridDivX && gridDivY == other.gridDivY && cachedLattice.isSameSetup(other.cachedLattice);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::blend(ofxBezierWarpMesh & a, ofxBezierWarpMesh & b, float t){
+    
+    if(!a.isBlendable(b) || &a == this || &b == this) return false;
+    
+    if(!isBlendable(a) || bAdaptive){
+        
+        // take the topology (and evaluation settings) from the first one
+        numXPoints = a.numXPoints;
+        numYPoints = a.numYPoints;
+        gridDivX = a.gridDivX;
+        gridDivY = a.gridDivY;
+        mode = a.mode;
+        gridEvaluator = a.gridEvaluator;
+        pointEvaluator = a.pointEvaluator;
+        bAdaptive = bBuiltAdaptive = false;
+        texCoords = a.texCoords;
+        indices = a.indices;
+        lineIndices = a.lineIndices;
+        bDrawIndicesDirty = true;
+        vertices.resize(a.vertices.size());
+        cachedCntrlPoints.resize(a.cachedCntrlPoints.size());
+    }
+    
+    // keep the net in step too so a later update() only
+    // re-evaluates whatever moves away from the blend
+    int numValues = vertices.size();
+    memset(&vertices[0], 0, numValues * sizeof(GLfloat));
+    axpy(&vertices[0], &a.vertices[0], 1.0f - t, numValues);
+    axpy(&vertices[0], &b.vertices[0], t, numValues);
+    
+    int numPoints = cachedCntrlPoints.size();
+    memset(&cachedCntrlPoints[0], 0, numPoints * sizeof(GLfloat));
+    axpy(&cachedCntrlPoints[0], &a.cachedCntrlPoints[0], 1.0f - t, numPoints);
+    axpy(&cachedCntrlPoints[0], &b.cachedCntrlPoints[0], t, numPoints);
+    
+    cachedLattice.blend(a.cachedLattice, b.cachedLattice, t);
+    
+    version++;
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::rebuildTopology(){
+    
+    int numCols = gridDivX + 1;
+    int numRows = gridDivY + 1;
+    
+    // texture coordinates are normalized to match the old
+    // GL_MAP2_TEXTURE_COORD_2 map (0,0) -> (1,1) across the surface
+    texCoords.resize(numCols * numRows * 2);
+    for(int j = 0; j < numRows; j++){
+        for(int i = 0; i < numCols; i++){
+            texCoords[(j*numCols+i)*2+0] = (GLfloat)i / gridDivX;
+            texCoords[(j*numCols+i)*2+1] = (GLfloat)j / gridDivY;
+        }
+    }
+    
+    bDrawIndicesDirty = true;
+    
+    indices.resize(gridDivX * gridDivY * 6);
+    int n = 0;
+    for(int j = 0; j < gridDivY; j++){
+        for(int i = 0; i < gridDivX; i++){
+            GLuint a = j * numCols + i;
+            GLuint b = a + 1;
+            GLuint c = a + numCols;
+            GLuint d = c + 1;
+            indices[n++] = a; indices[n++] = b; indices[n++] = c;
+            indices[n++] = b; indices[n++] = d; indices[n++] = c;
+        }
+    }
+    
+    lineIndices.clear();
+    lineIndices.reserve((gridDivX * numRows + gridDivY * numCols) * 2);
+    for(int j = 0; j < numRows; j++){
+        for(int i = 0; i < gridDivX; i++){
+            lineIndices.push_back(j * numCols + i);
+            lineIndices.push_back(j * numCols + i + 1);
+        }
+    }
+    for(int i = 0; i < numCols; i++){
+        for(int j = 0; j < gridDivY; j++){
+            lineIndices.push_back(j * numCols + i);
+            lineIndices.push_back((j + 1) * numCols + i);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::rebuildVertices(){
+    rebuildVertices(0, 0, numXPoints - 1, numYPoints - 1);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::rebuildVertices(int minX, int minY, int maxX, int maxY){
+    
+    // the surface is a tensor product so every row of vertices can be
+    // done as two small matrix products using the precomputed tables:
+    //   row[k] = sum over l of basisY(j, l) * cntrl[l][k]     (along v)
+    //   vert[i] = sum over k of basisX(i, k) * row[k]         (along u)
+    // both are sequences of axpy's which is what the SIMD kernels do
+    
+    if(!basisX.isSetup(mode, numXPoints, gridDivX)) basisX.setup(mode, numXPoints, gridDivX);
+    if(!basisY.isSetup(mode, numYPoints, gridDivY)) basisY.setup(mode, numYPoints, gridDivY);
+    
+    int numCols = gridDivX + 1;
+    int numRows = gridDivY + 1;
+    
+    vertices.resize(numCols * numRows * 3);
+    
+    // every point of a bezier net supports the whole surface so
+    // the fixed size versions always do all of it
+    if(bUseFixedEvaluators && gridEvaluator != NULL){
+        int numComponents = 2;
+        for(size_t p = 2; p < cachedCntrlPoints.size(); p += 3){
+            if(cachedCntrlPoints[p] != 0.0f){
+                numComponents = 3;
+                break;
+            }
+        }
+        gridEvaluator(&cachedCntrlPoints[0], gridDivX, gridDivY, 0, numRows, &vertices[0], numComponents);
+        cachedLattice.addDisplacement(&vertices[0], gridDivX, gridDivY, 0, numCols, 0, numRows);
+        return;
+    }
+    
+    // only the samples supported by the moved control points need doing
+    int colBegin = basisX.getSampleBegin(minX);
+    int colEnd = basisX.getSampleEnd(maxX);
+    int rowBegin = basisY.getSampleBegin(minY);
+    int rowEnd = basisY.getSampleEnd(maxY);
+    
+    // split the interleaved xyz control points into planes
+    int numPoints = numXPoints * numYPoints;
+    bool bHasZ = false;
+    planes.resize(numPoints * 3);
+    for(int p = 0; p < numPoints; p++){
+        planes[p] = cachedCntrlPoints[p*3+0];
+        planes[numPoints + p] = cachedCntrlPoints[p*3+1];
+        planes[numPoints * 2 + p] = cachedCntrlPoints[p*3+2];
+        if(planes[numPoints * 2 + p] != 0.0f) bHasZ = true;
+    }
+    
+    rowScratch.resize(numXPoints * 3);
+    colScratch.resize(numCols * 3);
+    
+    // z is almost always flat so don't bother evaluating it
+    int numComponents = bHasZ ? 3 : 2;
+    if(!bHasZ){
+        for(int i = colBegin; i < colEnd; i++) colScratch[numCols * 2 + i] = 0.0f;
+    }
+    
+    int spanY = basisY.getSpan();
+    
+    for(int j = rowBegin; j < rowEnd; j++){
+        
+        int firstY = basisY.getFirst(j);
+        const float * wv = basisY.getWeights(j);
+        
+        for(int c = 0; c < numComponents; c++){
+            
+            float * row = &rowScratch[c * numXPoints];
+            float * col = &colScratch[c * numCols];
+            const float * plane = &planes[c * numPoints];
+            
+            for(int k = 0; k < numXPoints; k++) row[k] = 0.0f;
+            for(int i = colBegin; i < colEnd; i++) col[i] = 0.0f;
+            
+            for(int l = 0; l < spanY; l++){
+                axpy(row, plane + (firstY + l) * numXPoints, wv[l], numXPoints);
+            }
+            
+            for(int k = 0; k < numXPoints; k++){
+                int b = MAX(colBegin, basisX.getSampleBegin(k));
+                int e = MIN(colEnd, basisX.getSampleEnd(k));
+                if(b < e) axpy(col + b, basisX.getColumn(k) + b, row[k], e - b);
+            }
+        }
+        
+        GLfloat * vert = &vertices[j * numCols * 3];
+        for(int i = colBegin; i < colEnd; i++){
+            vert[i*3+0] = colScratch[i];
+            vert[i*3+1] = colScratch[numCols + i];
+            vert[i*3+2] = colScratch[numCols * 2 + i];
+        }
+    }
+    
+    cachedLattice.addDisplacement(&vertices[0], gridDivX, gridDivY, colBegin, colEnd, rowBegin, rowEnd);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::rebuildAdaptive(){
+    
+    if(!basisX.isSetup(mode, numXPoints, gridDivX)) basisX.setup(mode, numXPoints, gridDivX);
+    if(!basisY.isSetup(mode, numYPoints, gridDivY)) basisY.setup(mode, numYPoints, gridDivY);
+    
+    int numCols = gridDivX + 1;
+    int numRows = gridDivY + 1;
+    
+    // surface samples on the full grid are only evaluated when
+    // the flatness tests or the final mesh actually ask for them
+    if(sampleStamps.size() != (size_t)(numCols * numRows)){
+        samples.resize(numCols * numRows * 3);
+        sampleIndices.resize(numCols * numRows);
+        sampleStamps.assign(numCols * numRows, 0);
+        indexStamps.assign(numCols * numRows, 0);
+        stamp = 0;
+    }
+    
+    stamp++;
+    bDrawIndicesDirty = true;
+    
+    vertices.clear();
+    texCoords.clear();
+    indices.clear();
+    lineIndices.clear();
+    cells.clear();
+    
+    // start with no cell bigger than the span between two control
+    // points so waves inside a patch can't hide between test samples
+    // (these get checked at quarters, anything smaller at halves)
+    int numCellsX = numXPoints - 1;
+    int numCellsY = numYPoints - 1;
+    
+    // same goes for the bumps of the finest lattice level with edits
+    for(int l = cachedLattice.getNumLevels() - 1; l >= 0; l--){
+        if(cachedLattice.getNumEdits(l) == 0) continue;
+        numCellsX = MAX(numCellsX, cachedLattice.getNumXNodes(l) - 1);
+        numCellsY = MAX(numCellsY, cachedLattice.getNumYNodes(l) - 1);
+        break;
+    }
+    
+    numCellsX = MIN(numCellsX, gridDivX);
+    numCellsY = MIN(numCellsY, gridDivY);
+    
+    for(int cy = 0; cy < numCellsY; cy++){
+        for(int cx = 0; cx < numCellsX; cx++){
+            subdivide(cx * gridDivX / numCellsX, cy * gridDivY / numCellsY,
+                      (cx + 1) * gridDivX / numCellsX, (cy + 1) * gridDivY / numCellsY, 4);
+        }
+    }
+    
+    // every cell corner becomes a vertex
+    for(size_t c = 0; c < cells.size(); c++){
+        const Cell & cell = cells[c];
+        getSampleIndex(cell.i0, cell.j0);
+        getSampleIndex(cell.i1, cell.j0);
+        getSampleIndex(cell.i0, cell.j1);
+        getSampleIndex(cell.i1, cell.j1);
+    }
+    
+    // walk each cell's outline picking up any corners of smaller
+    // neighbours on its edges - a plain quad if there aren't any,
+    // otherwise a fan from the middle so the T-junctions are shared
+    vector<GLuint> outline;
+    
+    for(size_t c = 0; c < cells.size(); c++){
+        
+        const Cell & cell = cells[c];
+        
+        outline.clear();
+        for(int i = cell.i0; i < cell.i1; i++){
+            if(indexStamps[cell.j0 * numCols + i] == stamp) outline.push_back(sampleIndices[cell.j0 * numCols + i]);
+        }
+        for(int j = cell.j0; j < cell.j1; j++){
+            if(indexStamps[j * numCols + cell.i1] == stamp) outline.push_back(sampleIndices[j * numCols + cell.i1]);
+        }
+        for(int i = cell.i1; i > cell.i0; i--){
+            if(indexStamps[cell.j1 * numCols + i] == stamp) outline.push_back(sampleIndices[cell.j1 * numCols + i]);
+        }
+        for(int j = cell.j1; j > cell.j0; j--){
+            if(indexStamps[j * numCols + cell.i0] == stamp) outline.push_back(sampleIndices[j * numCols + cell.i0]);
+        }
+        
+        if(outline.size() == 4){
+            
+            // same split as the uniform grid: a b c, b d c
+            GLuint a = outline[0], b = outline[1], d = outline[2], cc = outline[3];
+            indices.push_back(a); indices.push_back(b); indices.push_back(cc);
+            indices.push_back(b); indices.push_back(d); indices.push_back(cc);
+            
+        }else{
+            
+            float u = (cell.i0 + cell.i1) * 0.5f / gridDivX;
+            float v = (cell.j0 + cell.j1) * 0.5f / gridDivY;
+            GLfloat p[3];
+            evaluate(cachedCntrlPoints, numXPoints, numYPoints, u, v, p, mode);
+            cachedLattice.addDisplacement(u, v, p);
+            GLuint centre = addVertex(u, v, p);
+            
+            for(size_t k = 0; k < outline.size(); k++){
+                indices.push_back(centre);
+                indices.push_back(outline[k]);
+                indices.push_back(outline[(k + 1) % outline.size()]);
+            }
+        }
+        
+        // top and left edges belong to this cell, bottom and right
+        // to the neighbours - except along the edges of the mesh
+        for(int i = cell.i0, last = -1; i <= cell.i1; i++){
+            if(indexStamps[cell.j0 * numCols + i] != stamp) continue;
+            int index = sampleIndices[cell.j0 * numCols + i];
+            if(last != -1){ lineIndices.push_back(last); lineIndices.push_back(index); }
+            last = index;
+        }
+        for(int j = cell.j0, last = -1; j <= cell.j1; j++){
+            if(indexStamps[j * numCols + cell.i0] != stamp) continue;
+            int index = sampleIndices[j * numCols + cell.i0];
+            if(last != -1){ lineIndices.push_back(last); lineIndices.push_back(index); }
+            last = index;
+        }
+        if(cell.j1 == gridDivY){
+            lineIndices.push_back(sampleIndices[cell.j1 * numCols + cell.i0]);
+            lineIndices.push_back(sampleIndices[cell.j1 * numCols + cell.i1]);
+        }
+        if(cell.i1 == gridDivX){
+            lineIndices.push_back(sampleIndices[cell.j0 * numCols + cell.i1]);
+            lineIndices.push_back(sampleIndices[cell.j1 * numCols + cell.i1]);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::subdivide(int i0, int j0, int i1, int j1, int numTests){
+    
+    if(i1 <= i0 || j1 <= j0) return;
+    
+    if((i1 - i0 <= 1 && j1 - j0 <= 1) || isFlat(i0, j0, i1, j1, numTests)){
+        Cell cell;
+        cell.i0 = i0; cell.j0 = j0;
+        cell.i1 = i1; cell.j1 = j1;
+        cells.push_back(cell);
+        return;
+    }
+    
+    int mi = (i1 - i0 > 1) ? (i0 + i1) / 2 : i1;
+    int mj = (j1 - j0 > 1) ? (j0 + j1) / 2 : j1;
+    
+    subdivide(i0, j0, mi, mj, 2);
+    subdivide(mi, j0, i1, mj, 2);
+    subdivide(i0, mj, mi, j1, 2);
+    subdivide(mi, mj, i1, j1, 2);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::isFlat(int i0, int j0, int i1, int j1, int numTests){
+    
+    // compare the surface against the two triangles the cell would be
+    // drawn with at numTests steps across it (snapped to the grid)
+    
+    const GLfloat * a = getSample(i0, j0);
+    const GLfloat * b = getSample(i1, j0);
+    const GLfloat * c = getSample(i0, j1);
+    const GLfloat * d = getSample(i1, j1);
+    
+    float tolSq = tolerance * tolerance;
+    
+    for(int y = 0; y <= numTests; y++){
+        
+        int j = j0 + (j1 - j0) * y / numTests;
+        float s = (float)(j - j0) / (j1 - j0);
+        if(y > 0 && j == j0 + (j1 - j0) * (y - 1) / numTests) continue;
+        
+        for(int x = 0; x <= numTests; x++){
+            
+            int i = i0 + (i1 - i0) * x / numTests;
+            float t = (float)(i - i0) / (i1 - i0);
+            if(x > 0 && i == i0 + (i1 - i0) * (x - 1) / numTests) continue;
+            if((i == i0 || i == i1) && (j == j0 || j == j1)) continue;
+            
+            const GLfloat * p = getSample(i, j);
+            
+            float distSq = 0.0f;
+            for(int k = 0; k < 3; k++){
+                float flat;
+                if(t + s <= 1.0f){
+                    flat = a[k] + t * (b[k] - a[k]) + s * (c[k] - a[k]);
+                }else{
+                    flat = d[k] + (1.0f - t) * (c[k] - d[k]) + (1.0f - s) * (b[k] - d[k]);
+                }
+                distSq += (p[k] - flat) * (p[k] - flat);
+            }
+            
+            if(distSq > tolSq) return false;
+        }
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+const GLfloat * ofxBezierWarpMesh::getSample(int i, int j){
+    
+    int index = j * (gridDivX + 1) + i;
+    GLfloat * out = &samples[index * 3];
+    
+    if(sampleStamps[index] == stamp) return out;
+    
+    if(bUseFixedEvaluators && pointEvaluator != NULL){
+        pointEvaluator(&cachedCntrlPoints[0], (float)i / gridDivX, (float)j / gridDivY, out);
+        cachedLattice.addDisplacement((float)i / gridDivX, (float)j / gridDivY, out);
+        sampleStamps[index] = stamp;
+        return out;
+    }
+    
+    int spanX = basisX.getSpan();
+    int spanY = basisY.getSpan();
+    int firstX = basisX.getFirst(i);
+    int firstY = basisY.getFirst(j);
+    const float * wu = basisX.getWeights(i);
+    const float * wv = basisY.getWeights(j);
+    
+    out[0] = out[1] = out[2] = 0.0f;
+    
+    for(int l = 0; l < spanY; l++){
+        for(int k = 0; k < spanX; k++){
+            float w = wu[k] * wv[l];
+            const GLfloat * p = &cachedCntrlPoints[((firstY+l)*numXPoints+(firstX+k))*3];
+            out[0] += w * p[0];
+            out[1] += w * p[1];
+            out[2] += w * p[2];
+        }
+    }
+    
+    cachedLattice.addDisplacement((float)i / gridDivX, (float)j / gridDivY, out);
+    
+    sampleStamps[index] = stamp;
+    
+    return out;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getSampleIndex(int i, int j){
+    
+    int index = j * (gridDivX + 1) + i;
+    
+    if(indexStamps[index] != stamp){
+        sampleIndices[index] = addVertex((GLfloat)i / gridDivX, (GLfloat)j / gridDivY, getSample(i, j));
+        indexStamps[index] = stamp;
+    }
+    
+    return sampleIndices[index];
+}
+
+//--------------------------------------------------------------
+GLuint ofxBezierWarpMesh::addVertex(float u, float v, const GLfloat * p){
+    vertices.push_back(p[0]);
+    vertices.push_back(p[1]);
+    vertices.push_back(p[2]);
+    texCoords.push_back(u);
+    texCoords.push_back(v);
+    return vertices.size() / 3 - 1;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::axpy(float * dst, const float * src, float w, int count){
+    if(bUseSIMD){
+        ofxBezierWarpAxpy(dst, src, w, count);
+    }else{
+        ofxBezierWarpAxpyScalar(dst, src, w, count);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::setUseSIMD(bool b){
+    bUseSIMD = b;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::getUseSIMD(){
+    return bUseSIMD;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::setUseFixedEvaluators(bool b){
+    if(b != bUseFixedEvaluators) cachedCntrlPoints.clear();
+    bUseFixedEvaluators = b;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::getUseFixedEvaluators(){
+    return bUseFixedEvaluators;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::hasFixedEvaluator(){
+    return bUseFixedEvaluators && gridEvaluator != NULL;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::setAdaptive(bool b, float _tolerance){
+    bAdaptive = b;
+    tolerance = MAX(_tolerance, 0.01f);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::getAdaptive(){
+    return bAdaptive;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMesh::getTolerance(){
+    return tolerance;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::evaluate(const vector<GLfloat>& cntrlPoints, int numXPoints, int numYPoints, float u, float v, GLfloat * out, ofxBezierWarpMode mode){
+    
+    // same layout as glMap2f(GL_MAP2_VERTEX_3, 0, 1, 3, numXPoints, 0, 1, numXPoints * 3, numYPoints, ...)
+    // ie., u runs along the x control points and v along the y control points
+    
+    if(mode == OFX_BEZIER_WARP_BEZIER){
+        ofxBezierWarpPointEvaluator fixed = ofxBezierWarpGetPointEvaluator(numXPoints, numYPoints);
+        if(fixed != NULL){
+            fixed(&cntrlPoints[0], u, v, out);
+            return;
+        }
+    }
+    
+    int spanX = ofxBezierWarpBasisTable::getBasisSpan(mode, numXPoints);
+    int spanY = ofxBezierWarpBasisTable::getBasisSpan(mode, numYPoints);
+    
+    // the patch modes only ever need 4 weights so skip the allocations
+    // for them (this gets called a lot by the inverse and the mask)
+    float stackU[16], stackV[16];
+    vector<float> heapU, heapV;
+    float * bu = stackU;
+    float * bv = stackV;
+    if(spanX > 16){
+        heapU.resize(spanX);
+        bu = &heapU[0];
+    }
+    if(spanY > 16){
+        heapV.resize(spanY);
+        bv = &heapV[0];
+    }
+    
+    int firstX = ofxBezierWarpBasisTable::getBasisWeights(mode, numXPoints, u, bu);
+    int firstY = ofxBezierWarpBasisTable::getBasisWeights(mode, numYPoints, v, bv);
+    
+    out[0] = out[1] = out[2] = 0.0f;
+    
+    for(int j = 0; j < spanY; j++){
+        for(int i = 0; i < spanX; i++){
+            float w = bu[i] * bv[j];
+            const GLfloat * p = &cntrlPoints[((firstY+j)*numXPoints+(firstX+i))*3];
+            out[0] += w * p[0];
+            out[1] += w * p[1];
+            out[2] += w * p[2];
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::draw(){
+    
+    if(!isAllocated()) return;
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    
+    if(bDrawIndicesDirty) rebuildDrawIndices();
+    
+    glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+    glTexCoordPointer(2, GL_FLOAT, 0, &texCoords[0]);
+    
+#ifndef TARGET_OPENGLES
+    if(bDrawRestart){
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(drawShortIndices.size() > 0 ? 0xFFFF : 0xFFFFFFFF);
+    }
+#endif
+    
+    if(drawShortIndices.size() > 0){
+        glDrawElements(drawPrimitive, drawShortIndices.size(), GL_UNSIGNED_SHORT, &drawShortIndices[0]);
+    }else if(drawIndices.size() > 0){
+        glDrawElements(drawPrimitive, drawIndices.size(), GL_UNSIGNED_INT, &drawIndices[0]);
+    }else{
+        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, &indices[0]);
+    }
+    
+#ifndef TARGET_OPENGLES
+    if(bDrawRestart) glDisable(GL_PRIMITIVE_RESTART);
+#endif
+    
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::rebuildDrawIndices(){
+    
+    bDrawIndicesDirty = false;
+    bDrawRestart = false;
+    drawPrimitive = GL_TRIANGLES;
+    drawIndices.clear();
+    drawShortIndices.clear();
+    
+    if(indices.size() == 0) return;
+    
+    int numVertices = vertices.size() / 3;
+    
+    // the adaptive mesh is cells of all sizes so only forsyth makes sense
+    ofxBezierWarpIndexOutput output = indexOutput;
+    if(bBuiltAdaptive && output != OFX_BEZIER_WARP_INDEX_TRIANGLES) output = OFX_BEZIER_WARP_INDEX_FORSYTH;
+    
+    switch(output){
+        case OFX_BEZIER_WARP_INDEX_TILED:
+            buildTiled(drawIndices, false, false);
+            break;
+        case OFX_BEZIER_WARP_INDEX_FORSYTH:
+            optimizeForsyth(indices, numVertices, vertexCacheSize, drawIndices);
+            break;
+        case OFX_BEZIER_WARP_INDEX_STRIPS:
+            bDrawRestart = bUsePrimitiveRestart && isPrimitiveRestartSupported();
+            drawPrimitive = GL_TRIANGLE_STRIP;
+            buildTiled(drawIndices, true, bDrawRestart);
+            break;
+        default:
+            break;
+    }
+    
+    // 0xFFFF is kept back for the restart index
+    if(bUseShortIndices && numVertices < 0xFFFF){
+        const vector<GLuint> & src = drawIndices.size() > 0 ? drawIndices : indices;
+        drawShortIndices.resize(src.size());
+        for(size_t i = 0; i < src.size(); i++) drawShortIndices[i] = (GLushort)src[i];
+        drawIndices.clear();
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::buildTiled(vector<GLuint>& out, bool bStrips, bool bRestart){
+    
+    // walking the grid in bands of columns narrow enough that a row of
+    // the band is still in the cache when the next row comes along means
+    // nearly every vertex only misses once (instead of twice row by row)
+    int numCols = gridDivX + 1;
+    int bandWidth = MAX(1, vertexCacheSize / 2 - 1);
+    
+    out.clear();
+    out.reserve(bStrips ? (gridDivX / bandWidth + 1) * gridDivY * (bandWidth * 2 + 5) : indices.size());
+    
+    for(int i0 = 0; i0 < gridDivX; i0 += bandWidth){
+        
+        int i1 = MIN(i0 + bandWidth, gridDivX);
+        
+        for(int j = 0; j < gridDivY; j++){
+            
+            if(!bStrips){
+                for(int i = i0; i < i1; i++){
+                    GLuint a = j * numCols + i;
+                    GLuint b = a + 1;
+                    GLuint c = a + numCols;
+                    GLuint d = c + 1;
+                    out.push_back(a); out.push_back(b); out.push_back(c);
+                    out.push_back(b); out.push_back(d); out.push_back(c);
+                }
+                continue;
+            }
+            
+            // top, bottom, top... gives a c b, c b d for each cell - the
+            // same diagonal as the list but wound the other way, so each
+            // strip starts with its first vertex twice to flip it back
+            // (a degenerate join has to land that on an even index too)
+            GLuint first = j * numCols + i0;
+            if(out.size() > 0){
+                if(bRestart){
+                    out.push_back(0xFFFFFFFF);
+                }else{
+                    GLuint last = out.back();
+                    out.push_back(last);
+                    if(out.size() % 2 == 1) out.push_back(last);
+                }
+            }
+            out.push_back(first);
+            for(int i = i0; i <= i1; i++){
+                out.push_back(j * numCols + i);
+                out.push_back((j + 1) * numCols + i);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::optimizeForsyth(const vector<GLuint>& in, int numVertices, int cacheSize, vector<GLuint>& out){
+    
+    // Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": vertices
+    // score higher the more recently they were used and the fewer
+    // triangles they have left, and the best scoring triangle touching
+    // the (simulated LRU) cache goes next
+    int numTriangles = in.size() / 3;
+    cacheSize = MAX(4, cacheSize);
+    
+    out.clear();
+    out.reserve(numTriangles * 3);
+    
+    // triangles using each vertex - the ones still to go are kept at
+    // the front of each vertex's range
+    vector<int> offsets(numVertices + 1, 0);
+    for(int i = 0; i < numTriangles * 3; i++) offsets[in[i] + 1]++;
+    for(int v = 0; v < numVertices; v++) offsets[v + 1] += offsets[v];
+    vector<int> remaining(numVertices, 0);
+    vector<int> vertexTriangles(numTriangles * 3);
+    for(int t = 0; t < numTriangles; t++){
+        for(int k = 0; k < 3; k++){
+            int v = in[t * 3 + k];
+            vertexTriangles[offsets[v] + remaining[v]++] = t;
+        }
+    }
+    
+    vector<int> cachePos(numVertices, -1);
+    vector<float> scores(numVertices);
+    vector<bool> bAdded(numTriangles, false);
+    vector<int> cache, nextCache;
+    cache.reserve(cacheSize + 3);
+    nextCache.reserve(cacheSize + 3);
+    
+    for(int v = 0; v < numVertices; v++) scores[v] = getForsythScore(-1, remaining[v], cacheSize);
+    
+    int best = -1;
+    int nextUnadded = 0;
+    
+    for(int n = 0; n < numTriangles; n++){
+        
+        // nothing in the cache has triangles left so start somewhere new
+        if(best == -1){
+            while(bAdded[nextUnadded]) nextUnadded++;
+            best = nextUnadded;
+        }
+        
+        bAdded[best] = true;
+        
+        const GLuint * tri = &in[best * 3];
+        out.push_back(tri[0]); out.push_back(tri[1]); out.push_back(tri[2]);
+        
+        for(int k = 0; k < 3; k++){
+            int v = tri[k];
+            int * first = &vertexTriangles[offsets[v]];
+            for(int t = 0; t < remaining[v]; t++){
+                if(first[t] == best){
+                    first[t] = first[remaining[v] - 1];
+                    first[remaining[v] - 1] = best;
+                    remaining[v]--;
+                    break;
+                }
+            }
+        }
+        
+        // the triangle's vertices move to the front of the cache
+        nextCache.clear();
+        for(int k = 0; k < 3; k++) nextCache.push_back(tri[k]);
+        for(size_t c = 0; c < cache.size(); c++){
+            int v = cache[c];
+            if(v != (int)tri[0] && v != (int)tri[1] && v != (int)tri[2]) nextCache.push_back(v);
+        }
+        for(size_t c = cacheSize; c < nextCache.size(); c++){
+            cachePos[nextCache[c]] = -1;
+            scores[nextCache[c]] = getForsythScore(-1, remaining[nextCache[c]], cacheSize);
+        }
+        if(nextCache.size() > (size_t)cacheSize) nextCache.resize(cacheSize);
+        cache.swap(nextCache);
+        
+        for(size_t c = 0; c < cache.size(); c++){
+            cachePos[cache[c]] = c;
+            scores[cache[c]] = getForsythScore(c, remaining[cache[c]], cacheSize);
+        }
+        
+        // only triangles touching the cache changed score
+        best = -1;
+        float bestScore = -1.0f;
+        for(size_t c = 0; c < cache.size(); c++){
+            int v = cache[c];
+            const int * first = &vertexTriangles[offsets[v]];
+            for(int t = 0; t < remaining[v]; t++){
+                const GLuint * other = &in[first[t] * 3];
+                float score = scores[other[0]] + scores[other[1]] + scores[other[2]];
+                if(score > bestScore){
+                    bestScore = score;
+                    best = first[t];
+                }
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMesh::getForsythScore(int cachePos, int numRemaining, int cacheSize){
+    
+    if(numRemaining == 0) return -1.0f;
+    
+    float score = 0.0f;
+    
+    if(cachePos >= 0){
+        // the last triangle's vertices get a fixed score so the next one
+        // doesn't just fan around whichever of them was used first
+        if(cachePos < 3){
+            score = 0.75f;
+        }else{
+            score = powf(1.0f - (float)(cachePos - 3) / (cacheSize - 3), 1.5f);
+        }
+    }
+    
+    // and vertices with only a few triangles left get finished off
+    return score + 2.0f / sqrtf((float)numRemaining);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::isPrimitiveRestartSupported(){
+#ifdef TARGET_OPENGLES
+    return false;
+#else
+    return GLEW_VERSION_3_1;
+#endif
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMesh::getACMR(const GLuint * indices, int numIndices, GLenum primitive, int cacheSize, GLuint restartIndex){
+    
+    // a FIFO cache like most hardware has (or used to) - only misses push
+    // anything in, and degenerate triangles (strip joins) don't count
+    vector<GLuint> fifo(MAX(1, cacheSize), 0xFFFFFFFF);
+    int head = 0;
+    int numMisses = 0;
+    int numTriangles = 0;
+    int numInStrip = 0;
+    
+    for(int i = 0; i < numIndices; i++){
+        
+        GLuint index = indices[i];
+        
+        if(primitive == GL_TRIANGLE_STRIP && index == restartIndex){
+            numInStrip = 0;
+            continue;
+        }
+        
+        if(find(fifo.begin(), fifo.end(), index) == fifo.end()){
+            fifo[head] = index;
+            head = (head + 1) % fifo.size();
+            numMisses++;
+        }
+        
+        if(primitive == GL_TRIANGLE_STRIP){
+            if(++numInStrip >= 3){
+                GLuint a = indices[i - 2], b = indices[i - 1];
+                if(a != b && b != index && a != index) numTriangles++;
+            }
+        }else if(i % 3 == 2){
+            numTriangles++;
+        }
+    }
+    
+    return numTriangles > 0 ? (float)numMisses / numTriangles : 0.0f;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMesh::getACMR(const GLushort * indices, int numIndices, GLenum primitive, int cacheSize){
+    vector<GLuint> wide(indices, indices + numIndices);
+    for(size_t i = 0; i < wide.size(); i++){
+        if(wide[i] == 0xFFFF) wide[i] = 0xFFFFFFFF;
+    }
+    return getACMR(wide.size() > 0 ? &wide[0] : NULL, numIndices, primitive, cacheSize);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::drawWireframe(){
+    
+    if(!isAllocated()) return;
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+    glDrawElements(GL_LINES, lineIndices.size(), GL_UNSIGNED_INT, &lineIndices[0]);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::isAllocated(){
+    return vertices.size() > 0 && indices.size() > 0;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getNumVertices(){
+    return vertices.size() / 3;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getNumIndices(){
+    return indices.size();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getGridDivisionsX(){
+    return gridDivX;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getGridDivisionsY(){
+    return gridDivY;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMode ofxBezierWarpMesh::getMode(){
+    return mode;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getNumXPoints(){
+    return numXPoints;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getNumYPoints(){
+    return numYPoints;
+}
+
+//--------------------------------------------------------------
+const vector<GLfloat>& ofxBezierWarpMesh::getControlPointsReference(){
+    return cachedCntrlPoints;
+}
+
+//--------------------------------------------------------------
+const ofxBezierWarpLattice& ofxBezierWarpMesh::getLatticeReference(){
+    return cachedLattice;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBezierWarpMesh::getVersion(){
+    return version;
+}
+
+//--------------------------------------------------------------
+vector<GLfloat>& ofxBezierWarpMesh::getVerticesReference(){
+    return vertices;
+}
+
+//--------------------------------------------------------------
+vector<GLfloat>& ofxBezierWarpMesh::getTexCoordsReference(){
+    return texCoords;
+}
+
+//--------------------------------------------------------------
+vector<GLuint>& ofxBezierWarpMesh::getIndicesReference(){
+    return indices;
+}
+
+//--------------------------------------------------------------
+vector<GLuint>& ofxBezierWarpMesh::getLineIndicesReference(){
+    return lineIndices;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::setIndexOutput(ofxBezierWarpIndexOutput output){
+    if(output != indexOutput) bDrawIndicesDirty = true;
+    indexOutput = output;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpIndexOutput ofxBezierWarpMesh::getIndexOutput(){
+    return indexOutput;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::setUseShortIndices(bool b){
+    if(b != bUseShortIndices) bDrawIndicesDirty = true;
+    bUseShortIndices = b;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::getUseShortIndices(){
+    return bUseShortIndices;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::setUsePrimitiveRestart(bool b){
+    if(b != bUsePrimitiveRestart) bDrawIndicesDirty = true;
+    bUsePrimitiveRestart = b;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpMesh::getUsePrimitiveRestart(){
+    return bUsePrimitiveRestart;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpMesh::setVertexCacheSize(int size){
+    size = MAX(4, size);
+    if(size != vertexCacheSize) bDrawIndicesDirty = true;
+    vertexCacheSize = size;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getVertexCacheSize(){
+    return vertexCacheSize;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getNumDrawIndices(){
+    if(bDrawIndicesDirty) rebuildDrawIndices();
+    if(drawShortIndices.size() > 0) return drawShortIndices.size();
+    if(drawIndices.size() > 0) return drawIndices.size();
+    return indices.size();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpMesh::getDrawIndexSize(){
+    if(bDrawIndicesDirty) rebuildDrawIndices();
+    return drawShortIndices.size() > 0 ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpMesh::getDrawACMR(int cacheSize){
+    if(bDrawIndicesDirty) rebuildDrawIndices();
+    if(cacheSize <= 0) cacheSize = vertexCacheSize;
+    if(drawShortIndices.size() > 0) return getACMR(&drawShortIndices[0], drawShortIndices.size(), drawPrimitive, cacheSize);
+    if(drawIndices.size() > 0) return getACMR(&drawIndices[0], drawIndices.size(), drawPrimitive, cacheSize);
+    if(indices.size() > 0) return getACMR(&indices[0], indices.size(), GL_TRIANGLES, cacheSize);
+    return 0.0f;
+}
@@ -0,0 +1,235 @@
+/*
+ * ofxBezierWarpMesh.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPMESH
+#define _H_OFXBEZIERWARPMESH
+
+#include "ofGraphics.h"
+#include "ofxBezierWarpBasisTable.h"
+#include "ofxBezierWarpEvaluator.h"
+#include "ofxBezierWarpLattice.h"
+
+// CPU evaluated version of the bezier surface that used to be drawn with
+// glEvalMesh2 - it is only re-evaluated when the control net or the grid
+// divisions actually change so a static warp costs a single draw call
+//
+// in adaptive mode the grid divisions are the finest the mesh will go and
+// cells are only split where the surface bends away from the flat triangles
+// by more than the tolerance (in pixels) - T-junctions between big and small
+// cells are fanned so the mesh never cracks
+//
+// a lattice adds its (local) edits on top of the net - when only the
+// lattice changes just the vertices under the nodes that changed move
+//
+// draw() can send the triangles in a different order (or as strips) to
+// get more out of the GPU's post transform vertex cache - the triangle
+// list in getIndicesReference() stays as it is for anything on the CPU
+
+enum ofxBezierWarpIndexOutput {
+    OFX_BEZIER_WARP_INDEX_TRIANGLES = 0,    // the triangle list as is, row by row
+    OFX_BEZIER_WARP_INDEX_TILED,            // triangle list walked in column bands that fit the cache
+    OFX_BEZIER_WARP_INDEX_FORSYTH,          // triangle list reordered with Forsyth's linear speed optimiser
+    OFX_BEZIER_WARP_INDEX_STRIPS            // a strip per row of each column band, joined by primitive restart
+};
+
+class ofxBezierWarpMesh {
+    
+public:
+	
+    ofxBezierWarpMesh();
+    ~ofxBezierWarpMesh();
+    
+    bool update(const vector<GLfloat>& cntrlPoints, int numXPoints, int numYPoints, int gridDivX, int gridDivY, ofxBezierWarpMode mode = OFX_BEZIER_WARP_BEZIER,
+                const ofxBezierWarpLattice * lattice = NULL);
+    void clear();
+    
+    // the surface is linear in the control points so when two meshes share
+    // a topology (same net size, mode and uniform grid) mixing their vertices
+    // is the same as evaluating the mixed net - returns false if they don't
+    bool blend(ofxBezierWarpMesh & a, ofxBezierWarpMesh & b, float t);
+    bool isBlendable(ofxBezierWarpMesh & other);
+    
+    void draw();
+    void drawWireframe();
+    
+    bool isAllocated();
+    
+    int getNumVertices();
+    int getNumIndices();
+    
+    int getGridDivisionsX();
+    int getGridDivisionsY();
+    
+    ofxBezierWarpMode getMode();
+    
+    int getNumXPoints();
+    int getNumYPoints();
+    const vector<GLfloat>& getControlPointsReference();
+    const ofxBezierWarpLattice& getLatticeReference();
+    
+    // bumped every time the mesh is re-evaluated so anything built
+    // from it (eg., remap lookup tables) can tell when it is stale
+    unsigned int getVersion();
+    
+    void setUseSIMD(bool b);
+    bool getUseSIMD();
+    
+    // 2x2 to 4x4 bezier nets go through ofxBezierWarpEvaluator's fixed
+    // size versions - picked whenever the net size or mode changes
+    void setUseFixedEvaluators(bool b);
+    bool getUseFixedEvaluators();
+    bool hasFixedEvaluator();
+    
+    void setAdaptive(bool b, float tolerance = 0.5f);
+    bool getAdaptive();
+    float getTolerance();
+    
+    vector<GLfloat>& getVerticesReference();
+    vector<GLfloat>& getTexCoordsReference();
+    vector<GLuint>& getIndicesReference();
+    vector<GLuint>& getLineIndicesReference();
+    
+    // adaptive meshes aren't a grid so tiled and strips fall back to forsyth
+    void setIndexOutput(ofxBezierWarpIndexOutput output);
+    ofxBezierWarpIndexOutput getIndexOutput();
+    
+    // 16 bit indices whenever there are few enough vertices
+    void setUseShortIndices(bool b);
+    bool getUseShortIndices();
+    
+    // without it (or GL 3.1) strips are joined with degenerate triangles
+    void setUsePrimitiveRestart(bool b);
+    bool getUsePrimitiveRestart();
+    
+    // size (in vertices) of the cache the orderings are tuned for
+    void setVertexCacheSize(int size);
+    int getVertexCacheSize();
+    
+    // what draw() actually sends - the ACMR (average cache misses per
+    // triangle) runs the index stream through a FIFO cache of cacheSize
+    // vertices (0 for the vertex cache size): 3 means no reuse at all
+    // and a big grid can get down towards 0.5
+    int getNumDrawIndices();
+    int getDrawIndexSize();
+    float getDrawACMR(int cacheSize = 0);
+    
+    static float getACMR(const GLuint * indices, int numIndices, GLenum primitive, int cacheSize, GLuint restartIndex = 0xFFFFFFFF);
+    static float getACMR(const GLushort * indices, int numIndices, GLenum primitive, int cacheSize);
+    
+    static void evaluate(const vector<GLfloat>& cntrlPoints, int numXPoints, int numYPoints, float u, float v, GLfloat * out, ofxBezierWarpMode mode = OFX_BEZIER_WARP_BEZIER);
+    
+protected:
+	
+    void rebuildTopology();
+    void rebuildVertices();
+    void rebuildVertices(int minX, int minY, int maxX, int maxY);
+    void axpy(float * dst, const float * src, float w, int count);
+    
+    struct Cell {
+        int i0, j0, i1, j1;
+    };
+    
+    void rebuildAdaptive();
+    void subdivide(int i0, int j0, int i1, int j1, int numTests);
+    bool isFlat(int i0, int j0, int i1, int j1, int numTests);
+    const GLfloat * getSample(int i, int j);
+    int getSampleIndex(int i, int j);
+    GLuint addVertex(float u, float v, const GLfloat * p);
+    
+    void rebuildDrawIndices();
+    void buildTiled(vector<GLuint>& out, bool bStrips, bool bRestart);
+    static void optimizeForsyth(const vector<GLuint>& in, int numVertices, int cacheSize, vector<GLuint>& out);
+    static float getForsythScore(int cachePos, int numRemaining, int cacheSize);
+    static bool isPrimitiveRestartSupported();
+    
+    ofxBezierWarpIndexOutput indexOutput;
+    bool bUseShortIndices;
+    bool bUsePrimitiveRestart;
+    int vertexCacheSize;
+    
+    // rebuilt on the next draw() after the topology changes - an empty
+    // drawIndices means the plain triangle list gets drawn straight
+    bool bDrawIndicesDirty;
+    bool bDrawRestart;
+    GLenum drawPrimitive;
+    vector<GLuint> drawIndices;
+    vector<GLushort> drawShortIndices;
+    
+    bool bAdaptive;
+    bool bBuiltAdaptive;
+    float tolerance;
+    float builtTolerance;
+    
+    // per grid point caches, valid when their stamp matches the
+    // current one so nothing has to be cleared between rebuilds
+    vector<Cell> cells;
+    vector<GLfloat> samples;
+    vector<unsigned int> sampleStamps;
+    vector<unsigned int> indexStamps;
+    vector<GLuint> sampleIndices;
+    unsigned int stamp;
+    
+    ofxBezierWarpMode mode;
+    bool bUseSIMD;
+    bool bUseFixedEvaluators;
+    ofxBezierWarpGridEvaluator gridEvaluator;
+    ofxBezierWarpPointEvaluator pointEvaluator;
+    unsigned int version;
+    
+    ofxBezierWarpBasisTable basisX;
+    ofxBezierWarpBasisTable basisY;
+    
+    vector<float> planes;
+    vector<float> rowScratch;
+    vector<float> colScratch;
+    
+    int numXPoints;
+    int numYPoints;
+    
+    int gridDivX;
+    int gridDivY;
+    
+    vector<GLfloat> cachedCntrlPoints;
+    ofxBezierWarpLattice cachedLattice;
+    ofxBezierWarpLattice latticeDifference;
+    
+    vector<GLfloat> vertices;
+    vector<GLfloat> texCoords;
+    vector<GLuint> indices;
+    vector<GLuint> lineIndices;
+    
+private:
+	
+};
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * ofxBezierWarpPointIndex.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#include "ofxBezierWarpPointIndex.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpPointIndex::ofxBezierWarpPointIndex(){
+    originX = 0;
+    originY = 0;
+    cellSize = 1;
+    numCellsX = 0;
+    numCellsY = 0;
+    crowdLimit = 0;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpPointIndex::~ofxBezierWarpPointIndex(){
+    clear();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPointIndex::update(const vector<GLfloat>& points){
+    
+    if(points.size() != cachedPoints.size()){
+        cachedPoints = points;
+        rebuild();
+        return true;
+    }
+    
+    // the points can be written straight through the warp's reference
+    // so look for what moved - it's the cell lookups we're saving on
+    bool bMoved = false;
+    bool bRebuild = false;
+    int numPoints = getNumPoints();
+    
+    for(int p = 0; p < numPoints; p++){
+        
+        if(cachedPoints[p*3+0] == points[p*3+0] && cachedPoints[p*3+1] == points[p*3+1]) continue;
+        
+        cachedPoints[p*3+0] = points[p*3+0];
+        cachedPoints[p*3+1] = points[p*3+1];
+        cachedPoints[p*3+2] = points[p*3+2];
+        bMoved = true;
+        
+        // points outside the grid would pile up in the edge cells (every
+        // query still checks real distances, they just cost more and more)
+        // so the grid gets fitted again once everything has been copied
+        if(bRebuild) continue;
+        if(isOutside(points[p*3+0], points[p*3+1])){
+            bRebuild = true;
+            continue;
+        }
+        
+        int cell = getCellY(points[p*3+1]) * numCellsX + getCellX(points[p*3+0]);
+        if(cell == pointCells[p]) continue;
+        
+        vector<int>& from = cells[pointCells[p]];
+        for(size_t k = 0; k < from.size(); k++){
+            if(from[k] == p){
+                from[k] = from.back();
+                from.pop_back();
+                break;
+            }
+        }
+        
+        cells[cell].push_back(p);
+        pointCells[p] = cell;
+        
+        // same again if the net has shrunk or bunched up into a few cells
+        if(cells[cell].size() > crowdLimit) bRebuild = true;
+    }
+    
+    if(bRebuild) rebuild();
+    
+    return bMoved;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPointIndex::clear(){
+    cachedPoints.clear();
+    cells.clear();
+    pointCells.clear();
+    numCellsX = 0;
+    numCellsY = 0;
+    crowdLimit = 0;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPointIndex::rebuild(){
+    
+    int numPoints = getNumPoints();
+    
+    cells.clear();
+    pointCells.resize(numPoints);
+    
+    if(numPoints == 0){
+        numCellsX = numCellsY = 0;
+        return;
+    }
+    
+    float minX = cachedPoints[0], maxX = cachedPoints[0];
+    float minY = cachedPoints[1], maxY = cachedPoints[1];
+    for(int p = 1; p < numPoints; p++){
+        minX = MIN(minX, cachedPoints[p*3+0]); maxX = MAX(maxX, cachedPoints[p*3+0]);
+        minY = MIN(minY, cachedPoints[p*3+1]); maxY = MAX(maxY, cachedPoints[p*3+1]);
+    }
+    
+    // about one point per cell when they're spread out evenly, with a
+    // margin all round so dragging a point off the edge doesn't mean a
+    // rebuild every frame
+    float w = MAX(maxX - minX, 1.0f);
+    float h = MAX(maxY - minY, 1.0f);
+    float marginX = w * 0.25f;
+    float marginY = h * 0.25f;
+    cellSize = MAX(sqrtf(w * h / numPoints), 1.0f);
+    cellSize = MAX(cellSize, MAX((w + marginX * 2.0f) / 1023, (h + marginY * 2.0f) / 1023));
+    
+    originX = minX - marginX;
+    originY = minY - marginY;
+    numCellsX = MIN((int)((w + marginX * 2.0f) / cellSize) + 1, 1024);
+    numCellsY = MIN((int)((h + marginY * 2.0f) / cellSize) + 1, 1024);
+    
+    cells.resize(numCellsX * numCellsY);
+    
+    size_t mostInCell = 0;
+    
+    for(int p = 0; p < numPoints; p++){
+        int cell = getCellY(cachedPoints[p*3+1]) * numCellsX + getCellX(cachedPoints[p*3+0]);
+        cells[cell].push_back(p);
+        pointCells[p] = cell;
+        mostInCell = MAX(mostInCell, cells[cell].size());
+    }
+    
+    // leave room for the net to move about before fitting it again (and
+    // don't keep refitting one that's just bunched up to start with)
+    crowdLimit = MAX(mostInCell * 2, (size_t)8);
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPointIndex::isOutside(float x, float y){
+    return x < originX || y < originY || x >= originX + numCellsX * cellSize || y >= originY + numCellsY * cellSize;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpPointIndex::getCellX(float x){
+    return ofClamp(floorf((x - originX) / cellSize), 0, numCellsX - 1);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpPointIndex::getCellY(float y){
+    return ofClamp(floorf((y - originY) / cellSize), 0, numCellsY - 1);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPointIndex::getCellRange(float minX, float minY, float maxX, float maxY, int & cx0, int & cy0, int & cx1, int & cy1){
+    cx0 = getCellX(minX);
+    cy0 = getCellY(minY);
+    cx1 = getCellX(maxX);
+    cy1 = getCellY(maxY);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpPointIndex::findNearest(float x, float y, float radius, float scaleX, float scaleY){
+    
+    if(numCellsX == 0 || scaleX <= 0 || scaleY <= 0) return -1;
+    
+    int cx0, cy0, cx1, cy1;
+    getCellRange(x - radius / scaleX, y - radius / scaleY, x + radius / scaleX, y + radius / scaleY, cx0, cy0, cx1, cy1);
+    
+    int nearest = -1;
+    float nearestDistSq = radius * radius;
+    
+    for(int cy = cy0; cy <= cy1; cy++){
+        for(int cx = cx0; cx <= cx1; cx++){
+            const vector<int>& cell = cells[cy * numCellsX + cx];
+            for(size_t k = 0; k < cell.size(); k++){
+                int p = cell[k];
+                float dx = (cachedPoints[p*3+0] - x) * scaleX;
+                float dy = (cachedPoints[p*3+1] - y) * scaleY;
+                float distSq = dx * dx + dy * dy;
+                if(distSq < nearestDistSq || (distSq == nearestDistSq && (nearest == -1 || p < nearest))){
+                    nearest = p;
+                    nearestDistSq = distSq;
+                }
+            }
+        }
+    }
+    
+    return nearest;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPointIndex::findInRadius(float x, float y, float radius, vector<int>& results, float scaleX, float scaleY){
+    
+    results.clear();
+    
+    if(numCellsX == 0 || scaleX <= 0 || scaleY <= 0) return;
+    
+    int cx0, cy0, cx1, cy1;
+    getCellRange(x - radius / scaleX, y - radius / scaleY, x + radius / scaleX, y + radius / scaleY, cx0, cy0, cx1, cy1);
+    
+    for(int cy = cy0; cy <= cy1; cy++){
+        for(int cx = cx0; cx <= cx1; cx++){
+            const vector<int>& cell = cells[cy * numCellsX + cx];
+            for(size_t k = 0; k < cell.size(); k++){
+                int p = cell[k];
+                float dx = (cachedPoints[p*3+0] - x) * scaleX;
+                float dy = (cachedPoints[p*3+1] - y) * scaleY;
+                if(dx * dx + dy * dy <= radius * radius) results.push_back(p);
+            }
+        }
+    }
+    
+    // same order as the control points whatever the cells look like
+    sort(results.begin(), results.end());
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPointIndex::findInRect(float x, float y, float w, float h, vector<int>& results){
+    
+    results.clear();
+    
+    if(numCellsX == 0) return;
+    
+    if(w < 0){ x += w; w = -w; }
+    if(h < 0){ y += h; h = -h; }
+    
+    int cx0, cy0, cx1, cy1;
+    getCellRange(x, y, x + w, y + h, cx0, cy0, cx1, cy1);
+    
+    for(int cy = cy0; cy <= cy1; cy++){
+        for(int cx = cx0; cx <= cx1; cx++){
+            const vector<int>& cell = cells[cy * numCellsX + cx];
+            for(size_t k = 0; k < cell.size(); k++){
+                int p = cell[k];
+                float px = cachedPoints[p*3+0];
+                float py = cachedPoints[p*3+1];
+                if(px >= x && px <= x + w && py >= y && py <= y + h) results.push_back(p);
+            }
+        }
+    }
+    
+    sort(results.begin(), results.end());
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpPointIndex::getNumPoints(){
+    return cachedPoints.size() / 3;
+}
@@ -0,0 +1,89 @@
+/*
+ * ofxBezierWarpPointIndex.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#ifndef _H_OFXBEZIERWARPPOINTINDEX
+#define _H_OFXBEZIERWARPPOINTINDEX
+
+#include "ofMain.h"
+
+// uniform grid over the control points so picking a point is a look at a
+// few cells instead of a scan of the whole net. Points that move are
+// shifted between cells rather than rebuilding everything
+//
+// queries take a scale from point space to the space the radius is in
+// (eg., the screen when the grid is drawn somewhere else) so the distance
+// test matches what the operator actually sees
+
+class ofxBezierWarpPointIndex {
+    
+public:
+	
+    ofxBezierWarpPointIndex();
+    ~ofxBezierWarpPointIndex();
+    
+    // interleaved xyz like the warp's control points - returns true if
+    // anything had to be moved
+    bool update(const vector<GLfloat>& points);
+    void clear();
+    
+    // nearest point within radius or -1 - exact ties go to the lowest index
+    int findNearest(float x, float y, float radius, float scaleX = 1.0f, float scaleY = 1.0f);
+    
+    void findInRadius(float x, float y, float radius, vector<int>& results, float scaleX = 1.0f, float scaleY = 1.0f);
+    void findInRect(float x, float y, float w, float h, vector<int>& results);
+    
+    int getNumPoints();
+    
+protected:
+	
+    void rebuild();
+    int getCellX(float x);
+    int getCellY(float y);
+    bool isOutside(float x, float y);
+    void getCellRange(float minX, float minY, float maxX, float maxY, int & cx0, int & cy0, int & cx1, int & cy1);
+    
+    vector<GLfloat> cachedPoints;
+    vector< vector<int> > cells;
+    vector<int> pointCells;
+    
+    float originX;
+    float originY;
+    float cellSize;
+    int numCellsX;
+    int numCellsY;
+    size_t crowdLimit;  // more than this in one cell and the grid gets fitted again
+    
+private:
+	
+};
+
+#endif
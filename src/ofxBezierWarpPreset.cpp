@@ -0,0 +1,444 @@
+/*
+ * ofxBezierWarpPreset.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#include "ofxBezierWarpPreset.h"
+#include "ofxBezierWarp.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char presetMagic[8] = {'O', 'F', 'X', 'B', 'W', 'P', 'R', 'E'};
+static const unsigned int presetFileVersion = 2;
+
+// the control points start on a 16 byte boundary after the header
+static const unsigned int presetDataOffset = (sizeof(ofxBezierWarpPreset::Header) + 15) & ~15;
+
+//--------------------------------------------------------------
+static unsigned long long hashBytes(unsigned long long hash, const void * data, size_t size){
+    // 64 bit FNV-1a
+    const unsigned char * bytes = (const unsigned char *)data;
+    for(size_t i = 0; i < size; i++){
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpPreset::ofxBezierWarpPreset(){
+    mapping = NULL;
+    mappingSize = 0;
+#ifdef TARGET_WIN32
+    fileHandle = NULL;
+    mappingHandle = NULL;
+#endif
+    clear();
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpPreset::~ofxBezierWarpPreset(){
+    clear();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPreset::setFromWarp(ofxBezierWarp & warp){
+    
+    clear();
+    
+    ofPoint offset = warp.getOffset();
+    ofRectangle position = warp.getWarpGridPosition();
+    
+    header.width = warp.getWidth();
+    header.height = warp.getHeight();
+    header.numXPoints = warp.getNumXPoints();
+    header.numYPoints = warp.getNumYPoints();
+    header.gridResolution = warp.gridResolution;
+    header.gridDivX = warp.getGridDivisionsX();
+    header.gridDivY = warp.getGridDivisionsY();
+    header.warpMode = warp.getWarpMode();
+    header.bAdaptive = warp.getWarpGridAdaptive();
+    header.tolerance = warp.getWarpGridTolerance();
+    header.offsetX = offset.x;
+    header.offsetY = offset.y;
+    header.offsetZ = offset.z;
+    header.bWarpPositionDiff = warp.getUseWarpGridPosition();
+    header.warpX = position.x;
+    header.warpY = position.y;
+    header.warpWidth = position.width;
+    header.warpHeight = position.height;
+    
+    ownedCntrlPoints = warp.getControlPointsReference();
+    header.numCntrlPoints = ownedCntrlPoints.size() / 3;
+    cntrlPoints = ownedCntrlPoints.size() > 0 ? &ownedCntrlPoints[0] : NULL;
+    
+    ofxBezierWarpLattice & lattice = warp.getLattice();
+    header.latticeXCells = lattice.isSetup() ? lattice.getNumXCells() : 0;
+    header.latticeYCells = lattice.isSetup() ? lattice.getNumYCells() : 0;
+    header.latticeLevels = lattice.getNumLevels();
+    
+    vector<ofxBezierWarpLattice::Edit> edits;
+    lattice.getEdits(edits);
+    
+    ownedLatticeEdits.resize(edits.size());
+    for(size_t k = 0; k < edits.size(); k++){
+        LatticeEdit & edit = ownedLatticeEdits[k];
+        edit.level = edits[k].level;
+        edit.i = edits[k].i;
+        edit.j = edits[k].j;
+        edit.offset[0] = edits[k].offset.x;
+        edit.offset[1] = edits[k].offset.y;
+        edit.offset[2] = edits[k].offset.z;
+    }
+    header.numLatticeEdits = ownedLatticeEdits.size();
+    latticeEdits = ownedLatticeEdits.size() > 0 ? &ownedLatticeEdits[0] : NULL;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPreset::applyToWarp(ofxBezierWarp & warp){
+    
+    if(!isAllocated()) return;
+    
+    // the resolution is only a single number if it was set as one
+    float pixelsPerGridDivision = header.gridResolution > 0 ? header.gridResolution : 100.0f;
+    
+    if(warp.getFBO().isAllocated()){
+        warp.allocate(header.width, header.height, header.numXPoints, header.numYPoints, pixelsPerGridDivision);
+    }else{
+        warp.setup(header.width, header.height, header.numXPoints, header.numYPoints, pixelsPerGridDivision);
+    }
+    
+    warp.setControlPoints(vector<GLfloat>(cntrlPoints, cntrlPoints + header.numCntrlPoints * 3));
+    warp.setWarpGridResolution(header.gridDivX, header.gridDivY);
+    warp.setWarpMode((ofxBezierWarpMode)header.warpMode);
+    warp.setWarpGridAdaptive(header.bAdaptive != 0, header.tolerance);
+    warp.setOffset(ofPoint(header.offsetX, header.offsetY, header.offsetZ));
+    
+    // setup() keeps the lattice the warp already had (edits and all)
+    applyToLattice(warp.getLattice());
+    
+    if(header.bWarpPositionDiff){
+        warp.setWarpGridPosition(header.warpX, header.warpY, header.warpWidth, header.warpHeight);
+    }else{
+        warp.resetWarpGridPosition();
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPreset::applyToLattice(ofxBezierWarpLattice & lattice){
+    
+    if(!isAllocated()) return;
+    
+    if(header.latticeXCells > 0 && header.latticeYCells > 0){
+        lattice.setup(header.latticeXCells, header.latticeYCells, header.latticeLevels);
+    }else{
+        lattice.clear();
+    }
+    
+    for(unsigned int k = 0; k < header.numLatticeEdits; k++){
+        const LatticeEdit & edit = latticeEdits[k];
+        lattice.setOffset(edit.level, edit.i, edit.j, ofPoint(edit.offset[0], edit.offset[1], edit.offset[2]));
+    }
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPreset::save(string path){
+    
+    if(!isAllocated()) return false;
+    
+    ofstream file(ofToDataPath(path).c_str(), ios::out | ios::binary);
+    
+    if(!file.is_open()){
+        ofLogError() << "Could not open warp preset for writing: " << path;
+        return false;
+    }
+    
+    Header fileHeader = header;
+    memcpy(fileHeader.magic, presetMagic, sizeof(presetMagic));
+    fileHeader.version = presetFileVersion;
+    fileHeader.headerSize = sizeof(Header);
+    fileHeader.cntrlPointsOffset = presetDataOffset;
+    fileHeader.latticeEditsOffset = presetDataOffset + header.numCntrlPoints * 3 * sizeof(GLfloat);
+    memset(fileHeader.reserved, 0, sizeof(fileHeader.reserved));
+    fileHeader.checksum = makeChecksum(fileHeader, cntrlPoints, latticeEdits);
+    
+    char padding[16] = {0};
+    
+    file.write((const char *)&fileHeader, sizeof(fileHeader));
+    file.write(padding, presetDataOffset - sizeof(fileHeader));
+    file.write((const char *)cntrlPoints, header.numCntrlPoints * 3 * sizeof(GLfloat));
+    if(header.numLatticeEdits > 0) file.write((const char *)latticeEdits, header.numLatticeEdits * sizeof(LatticeEdit));
+    
+    return file.good();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPreset::load(string path){
+    
+    clear();
+    
+    if(!map(path)) return false;
+    
+    const Header * fileHeader = (const Header *)mapping;
+    
+    if(mappingSize < sizeof(Header) || memcmp(fileHeader->magic, presetMagic, sizeof(presetMagic)) != 0){
+        ofLogWarning() << "Not a valid warp preset file: " << path;
+        clear();
+        return false;
+    }
+    
+    // version 1 is the same but without a lattice (those fields were zeroed)
+    if(fileHeader->version < 1 || fileHeader->version > presetFileVersion || fileHeader->headerSize != sizeof(Header)){
+        ofLogWarning() << "Unsupported warp preset version " << fileHeader->version << ": " << path;
+        clear();
+        return false;
+    }
+    
+    size_t dataSize = (size_t)fileHeader->numCntrlPoints * 3 * sizeof(GLfloat);
+    
+    if(fileHeader->cntrlPointsOffset % sizeof(GLfloat) != 0 || fileHeader->cntrlPointsOffset < sizeof(Header) ||
+       fileHeader->cntrlPointsOffset + dataSize > mappingSize ||
+       fileHeader->numCntrlPoints != (unsigned int)(fileHeader->numXPoints * fileHeader->numYPoints)){
+        ofLogWarning() << "Warp preset file is truncated: " << path;
+        clear();
+        return false;
+    }
+    
+    size_t editsSize = (size_t)fileHeader->numLatticeEdits * sizeof(LatticeEdit);
+    
+    if(editsSize > 0 && (fileHeader->latticeEditsOffset % sizeof(int) != 0 || fileHeader->latticeEditsOffset < sizeof(Header) ||
+                         fileHeader->latticeEditsOffset + editsSize > mappingSize)){
+        ofLogWarning() << "Warp preset file is truncated: " << path;
+        clear();
+        return false;
+    }
+    
+    const GLfloat * fileCntrlPoints = (const GLfloat *)((const char *)mapping + fileHeader->cntrlPointsOffset);
+    const LatticeEdit * fileLatticeEdits = (const LatticeEdit *)((const char *)mapping + fileHeader->latticeEditsOffset);
+    
+    if(makeChecksum(*fileHeader, fileCntrlPoints, fileLatticeEdits) != fileHeader->checksum){
+        ofLogWarning() << "Warp preset checksum doesn't match: " << path;
+        clear();
+        return false;
+    }
+    
+    header = *fileHeader;
+    cntrlPoints = fileCntrlPoints;
+    latticeEdits = fileLatticeEdits;
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPreset::saveText(string path){
+    
+    if(!isAllocated()) return false;
+    
+    ofstream file(ofToDataPath(path).c_str(), ios::out);
+    
+    if(!file.is_open()){
+        ofLogError() << "Could not open warp preset for writing: " << path;
+        return false;
+    }
+    
+    // one value per line so diffs show exactly what moved
+    file << "# ofxBezierWarp preset v" << presetFileVersion << endl;
+    file << "width " << header.width << endl;
+    file << "height " << header.height << endl;
+    file << "numXPoints " << header.numXPoints << endl;
+    file << "numYPoints " << header.numYPoints << endl;
+    file << "gridResolution " << header.gridResolution << endl;
+    file << "gridDivX " << header.gridDivX << endl;
+    file << "gridDivY " << header.gridDivY << endl;
+    file << "warpMode " << header.warpMode << endl;
+    file << "adaptive " << header.bAdaptive << endl;
+    file << "tolerance " << header.tolerance << endl;
+    file << "offset " << header.offsetX << " " << header.offsetY << " " << header.offsetZ << endl;
+    file << "warpPosition " << header.bWarpPositionDiff << " " << header.warpX << " " << header.warpY << " "
+         << header.warpWidth << " " << header.warpHeight << endl;
+    file << "cntrlPoints " << header.numCntrlPoints << endl;
+    
+    file.precision(9);
+    for(int i = 0; i < header.numYPoints; i++){
+        for(int j = 0; j < header.numXPoints; j++){
+            const GLfloat * p = &cntrlPoints[(i*header.numXPoints+j)*3];
+            file << i << " " << j << " " << p[0] << " " << p[1] << " " << p[2] << endl;
+        }
+    }
+    
+    file << "lattice " << header.latticeXCells << " " << header.latticeYCells << " " << header.latticeLevels << endl;
+    file << "latticeEdits " << header.numLatticeEdits << endl;
+    
+    for(unsigned int k = 0; k < header.numLatticeEdits; k++){
+        const LatticeEdit & edit = latticeEdits[k];
+        file << edit.level << " " << edit.i << " " << edit.j << " " << edit.offset[0] << " " << edit.offset[1] << " " << edit.offset[2] << endl;
+    }
+    
+    return file.good();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPreset::clear(){
+    unmap();
+    memset(&header, 0, sizeof(header));
+    ownedCntrlPoints.clear();
+    cntrlPoints = NULL;
+    ownedLatticeEdits.clear();
+    latticeEdits = NULL;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPreset::isAllocated(){
+    return cntrlPoints != NULL && header.numCntrlPoints > 0;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPreset::isMapped(){
+    return mapping != NULL;
+}
+
+//--------------------------------------------------------------
+const ofxBezierWarpPreset::Header& ofxBezierWarpPreset::getHeader(){
+    return header;
+}
+
+//--------------------------------------------------------------
+const GLfloat * ofxBezierWarpPreset::getControlPoints(){
+    return cntrlPoints;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpPreset::getNumControlPoints(){
+    return header.numCntrlPoints;
+}
+
+//--------------------------------------------------------------
+const ofxBezierWarpPreset::LatticeEdit * ofxBezierWarpPreset::getLatticeEdits(){
+    return latticeEdits;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpPreset::getNumLatticeEdits(){
+    return header.numLatticeEdits;
+}
+
+//--------------------------------------------------------------
+unsigned long long ofxBezierWarpPreset::makeChecksum(const Header & fileHeader, const GLfloat * fileCntrlPoints, const LatticeEdit * fileLatticeEdits){
+    Header h = fileHeader;
+    h.checksum = 0;
+    unsigned long long hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, &h, sizeof(h));
+    if(h.numCntrlPoints > 0) hash = hashBytes(hash, fileCntrlPoints, h.numCntrlPoints * 3 * sizeof(GLfloat));
+    if(h.numLatticeEdits > 0) hash = hashBytes(hash, fileLatticeEdits, h.numLatticeEdits * sizeof(LatticeEdit));
+    return hash;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpPreset::map(string path){
+    
+    string fullPath = ofToDataPath(path);
+    
+#ifdef TARGET_WIN32
+    
+    HANDLE file = CreateFileA(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) return false;
+    
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0){
+        CloseHandle(file);
+        return false;
+    }
+    
+    HANDLE fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(fileMapping == NULL){
+        CloseHandle(file);
+        return false;
+    }
+    
+    mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    if(mapping == NULL){
+        CloseHandle(fileMapping);
+        CloseHandle(file);
+        return false;
+    }
+    
+    fileHandle = file;
+    mappingHandle = fileMapping;
+    mappingSize = (size_t)size.QuadPart;
+    
+#else
+    
+    int file = open(fullPath.c_str(), O_RDONLY);
+    if(file == -1) return false;
+    
+    struct stat info;
+    if(fstat(file, &info) != 0 || info.st_size == 0){
+        close(file);
+        return false;
+    }
+    
+    void * data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    
+    if(data == MAP_FAILED) return false;
+    
+    mapping = data;
+    mappingSize = info.st_size;
+    
+#endif
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpPreset::unmap(){
+    
+    if(mapping == NULL) return;
+    
+#ifdef TARGET_WIN32
+    UnmapViewOfFile(mapping);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = NULL;
+    fileHandle = NULL;
+#else
+    munmap(mapping, mappingSize);
+#endif
+    
+    mapping = NULL;
+    mappingSize = 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * ofxBezierWarpPreset.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#ifndef _H_OFXBEZIERWARPPRESET
+#define _H_OFXBEZIERWARPPRESET
+
+#include "ofMain.h"
+
+class ofxBezierWarp;
+class ofxBezierWarpLattice;
+
+// everything needed to put a warp back the way it was, in a small binary
+// file: a fixed size header followed by the control points and lattice
+// edits, aligned so load() can map the file and point straight at them
+// without copying or parsing anything. The header carries a version and
+// a checksum over the whole file. saveText() writes the same thing out
+// readable for diffing
+
+class ofxBezierWarpPreset {
+    
+public:
+	
+    struct Header {
+        char magic[8];
+        unsigned int version;
+        unsigned int headerSize;
+        unsigned long long checksum;
+        float width;
+        float height;
+        int numXPoints;
+        int numYPoints;
+        float gridResolution;
+        int gridDivX;
+        int gridDivY;
+        int warpMode;
+        int bAdaptive;
+        float tolerance;
+        float offsetX;
+        float offsetY;
+        float offsetZ;
+        int bWarpPositionDiff;
+        float warpX;
+        float warpY;
+        float warpWidth;
+        float warpHeight;
+        unsigned int cntrlPointsOffset;
+        unsigned int numCntrlPoints;
+        int latticeXCells;              // the lattice's setup (0 cells if it wasn't set up)
+        int latticeYCells;
+        int latticeLevels;
+        unsigned int latticeEditsOffset;
+        unsigned int numLatticeEdits;
+        unsigned int reserved[1];
+    };
+    
+    // one moved lattice node - they follow the control points
+    struct LatticeEdit {
+        int level;
+        int i;
+        int j;
+        float offset[3];
+    };
+    
+    ofxBezierWarpPreset();
+    ~ofxBezierWarpPreset();
+    
+    void setFromWarp(ofxBezierWarp & warp);
+    void applyToWarp(ofxBezierWarp & warp);
+    
+    // sets the lattice up the way it was saved and puts the edits back
+    // (anything it had before is gone)
+    void applyToLattice(ofxBezierWarpLattice & lattice);
+    
+    bool save(string path);
+    bool load(string path);
+    bool saveText(string path);
+    
+    void clear();
+    
+    bool isAllocated();
+    bool isMapped();
+    
+    const Header& getHeader();
+    
+    // numXPoints * numYPoints * 3 floats - inside the mapped file after load()
+    const GLfloat * getControlPoints();
+    int getNumControlPoints();
+    
+    const LatticeEdit * getLatticeEdits();
+    int getNumLatticeEdits();
+    
+protected:
+	
+    bool map(string path);
+    void unmap();
+    
+    static unsigned long long makeChecksum(const Header & header, const GLfloat * cntrlPoints, const LatticeEdit * latticeEdits);
+    
+    Header header;
+    vector<GLfloat> ownedCntrlPoints;
+    const GLfloat * cntrlPoints;
+    vector<LatticeEdit> ownedLatticeEdits;
+    const LatticeEdit * latticeEdits;
+    
+    void * mapping;
+    size_t mappingSize;
+#ifdef TARGET_WIN32
+    void * fileHandle;
+    void * mappingHandle;
+#endif
+    
+private:
+	
+};
+
+#endif
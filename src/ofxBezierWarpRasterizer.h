@@ -0,0 +1,143 @@
+/*
+ * ofxBezierWarpRasterizer.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPRASTERIZER
+#define _H_OFXBEZIERWARPRASTERIZER
+
+#include "ofxBezierWarpMesh.h"
+
+// edge function of the line from (ax, ay) to (bx, by) at (px, py). It's
+// always worked out from the same end of the line so the two triangles
+// either side of a shared edge get exactly opposite values
+
+static inline float ofxBezierWarpEdge(float ax, float ay, float bx, float by, float px, float py){
+    if(ax > bx || (ax == bx && ay > by)) return -((ax - bx) * (py - by) - (ay - by) * (px - bx));
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+// whether pixels exactly on an edge belong to this triangle: top-left fill
+// rule like GL, so they go to exactly one of the triangles sharing the edge
+// (side is the sign of the triangle's area)
+
+static inline bool ofxBezierWarpEdgeIsTopLeft(float ax, float ay, float bx, float by, float side){
+    float nx = -(by - ay) * side;
+    float ny = (bx - ax) * side;
+    return nx > 0.0f || (nx == 0.0f && ny > 0.0f);
+}
+
+// walks every output pixel (inside rows [bandBegin, bandEnd)) covered by
+// the warp mesh and hands op(x, y, u, v) the interpolated texture coords
+//
+// pixel centres are at +0.5 and triangles are visited in index order so
+// overlapping (folded) parts of the warp come out the same way as in GL
+
+template<class PixelOp>
+void ofxBezierWarpRasterizeTriangle(const GLfloat * a, const GLfloat * b, const GLfloat * c,
+                                    const GLfloat * ta, const GLfloat * tb, const GLfloat * tc,
+                                    float scaleX, float scaleY, int dstWidth, int bandBegin, int bandEnd,
+                                    PixelOp & op){
+    
+    float ax = a[0] * scaleX, ay = a[1] * scaleY;
+    float bx = b[0] * scaleX, by = b[1] * scaleY;
+    float cx = c[0] * scaleX, cy = c[1] * scaleY;
+    
+    float minY = MIN(ay, MIN(by, cy));
+    float maxY = MAX(ay, MAX(by, cy));
+    
+    int y0 = MAX(bandBegin, (int)ceil(minY - 0.5f));
+    int y1 = MIN(bandEnd - 1, (int)floor(maxY - 0.5f));
+    if(y0 > y1) return;
+    
+    float minX = MIN(ax, MIN(bx, cx));
+    float maxX = MAX(ax, MAX(bx, cx));
+    
+    int x0 = MAX(0, (int)ceil(minX - 0.5f));
+    int x1 = MIN(dstWidth - 1, (int)floor(maxX - 0.5f));
+    if(x0 > x1) return;
+    
+    float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    if(area == 0.0f) return;
+    float invArea = 1.0f / area;
+    
+    // the sign of area takes care of triangles that have been flipped
+    // over by the warp - inside is where every edge agrees with it
+    float side = area > 0.0f ? 1.0f : -1.0f;
+    bool bTopLeftA = ofxBezierWarpEdgeIsTopLeft(bx, by, cx, cy, side);
+    bool bTopLeftB = ofxBezierWarpEdgeIsTopLeft(cx, cy, ax, ay, side);
+    bool bTopLeftC = ofxBezierWarpEdgeIsTopLeft(ax, ay, bx, by, side);
+    
+    for(int y = y0; y <= y1; y++){
+        
+        float py = y + 0.5f;
+        
+        for(int x = x0; x <= x1; x++){
+            
+            float px = x + 0.5f;
+            
+            float ea = ofxBezierWarpEdge(bx, by, cx, cy, px, py);
+            float eb = ofxBezierWarpEdge(cx, cy, ax, ay, px, py);
+            float ec = ofxBezierWarpEdge(ax, ay, bx, by, px, py);
+            
+            float sa = ea * side, sb = eb * side, sc = ec * side;
+            if(sa < 0.0f || (sa == 0.0f && !bTopLeftA)) continue;
+            if(sb < 0.0f || (sb == 0.0f && !bTopLeftB)) continue;
+            if(sc < 0.0f || (sc == 0.0f && !bTopLeftC)) continue;
+            
+            // barycentric weights
+            float wa = ea * invArea;
+            float wb = eb * invArea;
+            float wc = ec * invArea;
+            
+            op(x, y, wa * ta[0] + wb * tb[0] + wc * tc[0], wa * ta[1] + wb * tb[1] + wc * tc[1]);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+template<class PixelOp>
+void ofxBezierWarpRasterizeMesh(ofxBezierWarpMesh & mesh, float scaleX, float scaleY, int dstWidth,
+                                int bandBegin, int bandEnd, PixelOp & op){
+    
+    vector<GLfloat>& vertices = mesh.getVerticesReference();
+    vector<GLfloat>& texCoords = mesh.getTexCoordsReference();
+    vector<GLuint>& indices = mesh.getIndicesReference();
+    
+    for(size_t i = 0; i + 2 < indices.size(); i += 3){
+        GLuint ia = indices[i], ib = indices[i + 1], ic = indices[i + 2];
+        ofxBezierWarpRasterizeTriangle(&vertices[ia * 3], &vertices[ib * 3], &vertices[ic * 3],
+                                       &texCoords[ia * 2], &texCoords[ib * 2], &texCoords[ic * 2],
+                                       scaleX, scaleY, dstWidth, bandBegin, bandEnd, op);
+    }
+}
+
+#endif
@@ -0,0 +1,1120 @@
+/*
+ * ofxBezierWarpRemap.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpRemap.h"
+#include "ofxBezierWarpRasterizer.h"
+#include "ofxBezierWarpSIMD.h"
+
+// output blocks for the tiled kernel and incremental remaps - a multiple
+// of the tile delta LUT tiles wide
+static const int blockWidth = 64;
+static const int blockHeight = 32;
+
+//--------------------------------------------------------------
+static inline void sampleBilinear(const unsigned char * src, int srcWidth, int srcHeight, int numChannels,
+                                  float x, float y, unsigned char * out, bool bUseSIMD = false){
+    
+    // pixel centres are at +0.5 so shift back before splitting into
+    // integer and fractional parts - edges clamp like GL_CLAMP_TO_EDGE
+    
+    x = ofClamp(x - 0.5f, 0.0f, srcWidth - 1.0f);
+    y = ofClamp(y - 0.5f, 0.0f, srcHeight - 1.0f);
+    
+    int x0 = (int)x;
+    int y0 = (int)y;
+    int x1 = MIN(x0 + 1, srcWidth - 1);
+    int y1 = MIN(y0 + 1, srcHeight - 1);
+    
+    const unsigned char * p00 = src + (y0 * srcWidth + x0) * numChannels;
+    const unsigned char * p10 = src + (y0 * srcWidth + x1) * numChannels;
+    const unsigned char * p01 = src + (y1 * srcWidth + x0) * numChannels;
+    const unsigned char * p11 = src + (y1 * srcWidth + x1) * numChannels;
+    
+    if(bUseSIMD && numChannels == 4){
+        ofxBezierWarpBilinearRGBA(p00, p10, p01, p11, x - x0, y - y0, out);
+    }else{
+        ofxBezierWarpBilinearScalar(p00, p10, p01, p11, x - x0, y - y0, out, numChannels);
+    }
+}
+
+//--------------------------------------------------------------
+static inline void sampleBilinearFixed(const unsigned char * src, int srcWidth, int srcHeight, int numChannels,
+                                       int x, int y, int fractionBits, unsigned char * out, bool bUseSIMD = false){
+    
+    // x and y are already shifted to pixel centres and clamped to the
+    // source - the fraction bits are used directly as integer weights
+    
+    int mask = (1 << fractionBits) - 1;
+    
+    int x0 = x >> fractionBits;
+    int y0 = y >> fractionBits;
+    int x1 = MIN(x0 + 1, srcWidth - 1);
+    int y1 = MIN(y0 + 1, srcHeight - 1);
+    
+    const unsigned char * p00 = src + (y0 * srcWidth + x0) * numChannels;
+    const unsigned char * p10 = src + (y0 * srcWidth + x1) * numChannels;
+    const unsigned char * p01 = src + (y1 * srcWidth + x0) * numChannels;
+    const unsigned char * p11 = src + (y1 * srcWidth + x1) * numChannels;
+    
+    if(bUseSIMD && numChannels == 4){
+        ofxBezierWarpBilinearFixedRGBA(p00, p10, p01, p11, x & mask, y & mask, fractionBits, out);
+    }else{
+        ofxBezierWarpBilinearFixedScalar(p00, p10, p01, p11, x & mask, y & mask, fractionBits, out, numChannels);
+    }
+}
+
+//--------------------------------------------------------------
+static inline void storeSample(unsigned char & out, float v){
+    out = (unsigned char)(v + 0.5f);
+}
+
+//--------------------------------------------------------------
+static inline void storeSample(unsigned short & out, float v){
+    out = (unsigned short)(v + 0.5f);
+}
+
+//--------------------------------------------------------------
+static inline void storeSample(float & out, float v){
+    out = v;
+}
+
+//--------------------------------------------------------------
+// rounds to the nearest value with the bottom bits clear (eg., P010)
+static inline void quantizeSample(unsigned short & v, int bits){
+    int q = MIN(v + (1 << (bits - 1)), 0xFFFF);
+    v = q & ~((1 << bits) - 1);
+}
+
+static inline void quantizeSample(unsigned char &, int){}
+static inline void quantizeSample(float &, int){}
+
+//--------------------------------------------------------------
+// scales a sample towards what an uncovered pixel gets (black, or mid chroma)
+template<class T>
+static inline void maskSample(T & v, T blank, int m){
+    storeSample(v, blank + ((float)v - blank) * m * (1.0f / 255.0f));
+}
+
+//--------------------------------------------------------------
+// same as the 8 bit masks - alpha is left alone
+static inline int getNumMaskedChannels(int numChannels){
+    return numChannels == 4 ? 3 : (numChannels == 2 ? 1 : numChannels);
+}
+
+//--------------------------------------------------------------
+template<class T>
+static inline void sampleBilinearPlane(const T * src, int srcWidth, int srcHeight, int numChannels,
+                                       float x, float y, T * out){
+    
+    x = ofClamp(x - 0.5f, 0.0f, srcWidth - 1.0f);
+    y = ofClamp(y - 0.5f, 0.0f, srcHeight - 1.0f);
+    
+    int x0 = (int)x;
+    int y0 = (int)y;
+    int x1 = MIN(x0 + 1, srcWidth - 1);
+    int y1 = MIN(y0 + 1, srcHeight - 1);
+    float fx = x - x0;
+    float fy = y - y0;
+    
+    const T * p00 = src + (y0 * srcWidth + x0) * numChannels;
+    const T * p10 = src + (y0 * srcWidth + x1) * numChannels;
+    const T * p01 = src + (y1 * srcWidth + x0) * numChannels;
+    const T * p11 = src + (y1 * srcWidth + x1) * numChannels;
+    
+    for(int c = 0; c < numChannels; c++){
+        float top = p00[c] + ((float)p10[c] - p00[c]) * fx;
+        float bottom = p01[c] + ((float)p11[c] - p01[c]) * fx;
+        storeSample(out[c], top + (bottom - top) * fy);
+    }
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpRemap::ofxBezierWarpRemap(){
+    numThreads = 0;
+    bPoolSetup = false;
+    bUseLUT = true;
+    kernel = OFX_BEZIER_WARP_REMAP_TILED;
+    lutMesh = NULL;
+    lutMeshVersion = 0;
+    lutMeshWidth = lutMeshHeight = 0;
+    bIncremental = false;
+    footprintKey = 0;
+    lastKey = 0;
+    lastDst = NULL;
+    lastNumChannels = 0;
+    lastMask = NULL;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpRemap::~ofxBezierWarpRemap(){
+    pool.close();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::setNumThreads(int _numThreads){
+    // 0 means one thread per core
+    numThreads = _numThreads;
+    bPoolSetup = false;
+    pool.close();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpRemap::getNumThreads(){
+    return pool.getNumThreads();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::setupPool(){
+    if(!bPoolSetup){
+        pool.setup(numThreads);
+        bPoolSetup = true;
+    }
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpRemap::getNumBands(int height){
+    // a few bands per thread evens out bands that cover more of the mesh
+    return MIN(height, pool.getNumThreads() * 4);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::setUseLUT(bool b){
+    bUseLUT = b;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpRemap::getUseLUT(){
+    return bUseLUT;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::setKernel(ofxBezierWarpRemapKernel _kernel){
+    kernel = _kernel;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpRemapKernel ofxBezierWarpRemap::getKernel(){
+    return kernel;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::setLUTCacheDirectory(string path){
+    lutCacheDirectory = path;
+}
+
+//--------------------------------------------------------------
+string ofxBezierWarpRemap::getLUTCacheDirectory(){
+    return lutCacheDirectory;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLUT& ofxBezierWarpRemap::getLUT(){
+    return lut;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMask& ofxBezierWarpRemap::getMask(){
+    return mask;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpThreadPool& ofxBezierWarpRemap::getThreadPool(){
+    setupPool();
+    return pool;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::updateLUT(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                                   int srcWidth, int srcHeight, int dstWidth, int dstHeight){
+    updateLUT(mesh, meshWidth, meshHeight, ofRectangle(0, 0, srcWidth, srcHeight), srcWidth, srcHeight, dstWidth, dstHeight);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::updateLUT(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                                   int srcWidth, int srcHeight, int dstWidth, int dstHeight){
+    
+    if(lut.isAllocated() && lutMesh == &mesh && lutMeshVersion == mesh.getVersion() &&
+       lutMeshWidth == meshWidth && lutMeshHeight == meshHeight &&
+       lut.getWidth() == dstWidth && lut.getHeight() == dstHeight &&
+       lut.getSourceWidth() == srcWidth && lut.getSourceHeight() == srcHeight &&
+       lutSourceRect.x == sourceRect.x && lutSourceRect.y == sourceRect.y &&
+       lutSourceRect.width == sourceRect.width && lutSourceRect.height == sourceRect.height) return;
+    
+    lutMesh = &mesh;
+    lutMeshVersion = mesh.getVersion();
+    lutMeshWidth = meshWidth;
+    lutMeshHeight = meshHeight;
+    lutSourceRect = sourceRect;
+    
+    unsigned long long key = ofxBezierWarpLUT::makeKey(mesh, meshWidth, meshHeight, sourceRect, srcWidth, srcHeight, dstWidth, dstHeight, lut.getFormat(), lut.getFractionBits());
+    
+    if(lut.isAllocated() && lut.getKey() == key) return;
+    
+    string path;
+    
+    if(lutCacheDirectory != ""){
+        
+        char name[64];
+        sprintf(name, "ofxBezierWarp_%016llx.lut", key);
+        path = lutCacheDirectory + "/" + name;
+        
+        if(lut.load(path)){
+            if(lut.getKey() == key){
+                ofLogVerbose() << "Loaded cached warp LUT: " << path;
+                return;
+            }
+            ofLogWarning() << "Cached warp LUT doesn't match its name, rebuilding: " << path;
+        }
+    }
+    
+    setupPool();
+    lut.build(mesh, meshWidth, meshHeight, sourceRect, srcWidth, srcHeight, dstWidth, dstHeight, &pool);
+    
+    if(path != "" && !lut.save(path)){
+        ofLogWarning() << "Could not cache warp LUT: " << path;
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::buildLUT(ofxBezierWarpLUT & table, ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                                  int srcWidth, int srcHeight, int dstWidth, int dstHeight){
+    setupPool();
+    table.build(mesh, meshWidth, meshHeight, sourceRect, srcWidth, srcHeight, dstWidth, dstHeight, &pool);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarp & warp, const ofPixels & src, ofPixels & dst){
+    
+    if(!dst.isAllocated() || dst.getNumChannels() != src.getNumChannels()){
+        dst.allocate(warp.getWidth(), warp.getHeight(), src.getNumChannels());
+    }
+    
+    remap(warp, src.getPixels(), src.getWidth(), src.getHeight(),
+          dst.getPixels(), dst.getWidth(), dst.getHeight(), src.getNumChannels());
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarp & warp, const unsigned char * src, int srcWidth, int srcHeight,
+                               unsigned char * dst, int dstWidth, int dstHeight, int numChannels){
+    
+    if(bIncremental && warp.getWidth() > 0 && warp.getHeight() > 0){
+        // whatever was marked between begin() and end() in warp pixels
+        float scaleX = srcWidth / warp.getWidth();
+        float scaleY = srcHeight / warp.getHeight();
+        vector<ofRectangle>& rects = warp.getDirtyRectsReference();
+        for(size_t i = 0; i < rects.size(); i++){
+            addDirtyRect(ofRectangle(rects[i].x * scaleX, rects[i].y * scaleY, rects[i].width * scaleX, rects[i].height * scaleY));
+        }
+    }
+    
+    remap(warp.getMesh(), warp.getWidth(), warp.getHeight(), src, srcWidth, srcHeight, dst, dstWidth, dstHeight, numChannels);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                               const unsigned char * src, int srcWidth, int srcHeight,
+                               unsigned char * dst, int dstWidth, int dstHeight, int numChannels){
+    remap(mesh, meshWidth, meshHeight, ofRectangle(0, 0, srcWidth, srcHeight), src, srcWidth, srcHeight, dst, dstWidth, dstHeight, numChannels);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                               const unsigned char * src, int srcWidth, int srcHeight,
+                               unsigned char * dst, int dstWidth, int dstHeight, int numChannels){
+    
+    if(numChannels < 1 || numChannels > 4){
+        ofLogError() << "Can only remap 1 to 4 channel pixels";
+        return;
+    }
+    
+    if(src == NULL || dst == NULL || srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) return;
+    
+    const unsigned char * maskData = NULL;
+    bool bMaskChanged = false;
+    
+    if(mask.isEnabled() && mesh.isAllocated() && meshWidth > 0 && meshHeight > 0){
+        setupPool();
+        bMaskChanged = mask.update(mesh, meshWidth, meshHeight, dstWidth, dstHeight, &pool);
+        maskData = mask.getData();
+    }
+    
+    if(bUseLUT && mesh.isAllocated() && meshWidth > 0 && meshHeight > 0){
+        
+        updateLUT(mesh, meshWidth, meshHeight, sourceRect, srcWidth, srcHeight, dstWidth, dstHeight);
+        
+        // only the dirty parts if the last remap left dst exactly as
+        // this table and mask would have (and nothing is known to have changed)
+        if(bIncremental && lut.getKey() == lastKey && dst == lastDst && numChannels == lastNumChannels &&
+           maskData == lastMask && !bMaskChanged){
+            remapDirty(src, dst, numChannels, maskData);
+        }else{
+            remap(lut, src, dst, numChannels, 0, maskData);
+            changedRects.assign(1, ofRectangle(0, 0, dstWidth, dstHeight));
+            lastKey = lut.getKey();
+            lastDst = dst;
+            lastNumChannels = numChannels;
+            lastMask = maskData;
+        }
+        
+        dirtyRects.clear();
+        return;
+    }
+    
+    changedRects.assign(1, ofRectangle(0, 0, dstWidth, dstHeight));
+    dirtyRects.clear();
+    lastDst = NULL;
+    
+    // like glClear in begin() anything the mesh doesn't cover is left black
+    memset(dst, 0, dstWidth * dstHeight * numChannels);
+    
+    if(!mesh.isAllocated() || meshWidth <= 0 || meshHeight <= 0) return;
+    
+    setupPool();
+    
+    RasterJob job;
+    job.mesh = &mesh;
+    job.scaleX = dstWidth / meshWidth;
+    job.scaleY = dstHeight / meshHeight;
+    job.src = src;
+    job.srcWidth = srcWidth;
+    job.srcHeight = srcHeight;
+    job.srcRect = sourceRect;
+    job.dst = dst;
+    job.dstWidth = dstWidth;
+    job.dstHeight = dstHeight;
+    job.mask = maskData;
+    job.numChannels = numChannels;
+    
+    int numBands = getNumBands(dstHeight);
+    job.bandHeight = (dstHeight + numBands - 1) / numBands;
+    numBands = (dstHeight + job.bandHeight - 1) / job.bandHeight;
+    
+    pool.run(job, numBands);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarpLUT & lut, const unsigned char * src, unsigned char * dst, int numChannels, int dstStride,
+                               const unsigned char * mask){
+    gather(lut, src, dst, numChannels, dstStride, mask, NULL);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarp & warp, const ofShortPixels & src, ofShortPixels & dst){
+    
+    if(!dst.isAllocated() || dst.getNumChannels() != src.getNumChannels()){
+        dst.allocate(warp.getWidth(), warp.getHeight(), src.getNumChannels());
+    }
+    
+    remap(warp.getMesh(), warp.getWidth(), warp.getHeight(), src.getPixels(), src.getWidth(), src.getHeight(),
+          dst.getPixels(), dst.getWidth(), dst.getHeight(), src.getNumChannels());
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarp & warp, const ofFloatPixels & src, ofFloatPixels & dst){
+    
+    if(!dst.isAllocated() || dst.getNumChannels() != src.getNumChannels()){
+        dst.allocate(warp.getWidth(), warp.getHeight(), src.getNumChannels());
+    }
+    
+    remap(warp.getMesh(), warp.getWidth(), warp.getHeight(), src.getPixels(), src.getWidth(), src.getHeight(),
+          dst.getPixels(), dst.getWidth(), dst.getHeight(), src.getNumChannels());
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                               const unsigned short * src, int srcWidth, int srcHeight,
+                               unsigned short * dst, int dstWidth, int dstHeight, int numChannels){
+    
+    if(src == NULL || dst == NULL) return;
+    
+    const unsigned char * maskData = NULL;
+    if(!prepareLUT(mesh, meshWidth, meshHeight, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, maskData)) return;
+    
+    unsigned short blank[4] = {0, 0, 0, 0};
+    remapPlane(src, srcWidth, srcHeight, dst, dstWidth, dstHeight, numChannels, 1, blank, 0,
+               maskData, getNumMaskedChannels(numChannels));
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                               const float * src, int srcWidth, int srcHeight,
+                               float * dst, int dstWidth, int dstHeight, int numChannels){
+    
+    if(src == NULL || dst == NULL) return;
+    
+    const unsigned char * maskData = NULL;
+    if(!prepareLUT(mesh, meshWidth, meshHeight, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, maskData)) return;
+    
+    float blank[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    remapPlane(src, srcWidth, srcHeight, dst, dstWidth, dstHeight, numChannels, 1, blank, 0,
+               maskData, getNumMaskedChannels(numChannels));
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remapYUV(ofxBezierWarp & warp, ofxBezierWarpYUVFormat format, const unsigned char * src, int srcWidth, int srcHeight,
+                                  unsigned char * dst, int dstWidth, int dstHeight){
+    remapYUV(warp.getMesh(), warp.getWidth(), warp.getHeight(), format, src, srcWidth, srcHeight, dst, dstWidth, dstHeight);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remapYUV(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofxBezierWarpYUVFormat format,
+                                  const unsigned char * src, int srcWidth, int srcHeight,
+                                  unsigned char * dst, int dstWidth, int dstHeight){
+    
+    if(src == NULL || dst == NULL) return;
+    
+    const unsigned char * maskData = NULL;
+    if(!prepareLUT(mesh, meshWidth, meshHeight, srcWidth, srcHeight, dstWidth, dstHeight, 1, maskData)) return;
+    
+    // the mask takes luma towards black and chroma towards mid grey
+    
+    // chroma planes are half size rounding up
+    int srcChromaWidth = (srcWidth + 1) / 2;
+    int srcChromaHeight = (srcHeight + 1) / 2;
+    int dstChromaWidth = (dstWidth + 1) / 2;
+    int dstChromaHeight = (dstHeight + 1) / 2;
+    
+    int srcLumaSize = srcWidth * srcHeight;
+    int dstLumaSize = dstWidth * dstHeight;
+    
+    switch(format){
+            
+        case OFX_BEZIER_WARP_YUV_I420:{
+            unsigned char mid[1] = {128};
+            int srcChromaSize = srcChromaWidth * srcChromaHeight;
+            int dstChromaSize = dstChromaWidth * dstChromaHeight;
+            gather(lut, src, dst, 1, 0, maskData, NULL);
+            remapPlane(src + srcLumaSize, srcChromaWidth, srcChromaHeight,
+                       dst + dstLumaSize, dstChromaWidth, dstChromaHeight, 1, 2, mid, 0, maskData, 1,
+                       src + srcLumaSize + srcChromaSize, dst + dstLumaSize + dstChromaSize);
+            break;
+        }
+            
+        case OFX_BEZIER_WARP_YUV_NV12:{
+            unsigned char mid[2] = {128, 128};
+            gather(lut, src, dst, 1, 0, maskData, NULL);
+            remapPlane(src + srcLumaSize, srcChromaWidth, srcChromaHeight,
+                       dst + dstLumaSize, dstChromaWidth, dstChromaHeight, 2, 2, mid, 0, maskData, 2);
+            break;
+        }
+            
+        case OFX_BEZIER_WARP_YUV_P010:{
+            // 10 bit samples in the top of 16 so the bottom 6 have to stay clear
+            unsigned short black[1] = {0};
+            unsigned short mid[2] = {512 << 6, 512 << 6};
+            const unsigned short * src16 = (const unsigned short *)src;
+            unsigned short * dst16 = (unsigned short *)dst;
+            remapPlane(src16, srcWidth, srcHeight, dst16, dstWidth, dstHeight, 1, 1, black, 6, maskData, 1);
+            remapPlane(src16 + srcLumaSize, srcChromaWidth, srcChromaHeight,
+                       dst16 + dstLumaSize, dstChromaWidth, dstChromaHeight, 2, 2, mid, 6, maskData, 2);
+            break;
+        }
+    }
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpRemap::getYUVSize(ofxBezierWarpYUVFormat format, int width, int height){
+    int size = width * height + ((width + 1) / 2) * ((height + 1) / 2) * 2;
+    return format == OFX_BEZIER_WARP_YUV_P010 ? size * 2 : size;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpRemap::prepareLUT(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                                    int srcWidth, int srcHeight, int dstWidth, int dstHeight, int numChannels,
+                                    const unsigned char *& maskData){
+    
+    if(numChannels < 1 || numChannels > 4){
+        ofLogError() << "Can only remap 1 to 4 channel pixels";
+        return false;
+    }
+    
+    if(srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) return false;
+    if(!mesh.isAllocated() || meshWidth <= 0 || meshHeight <= 0) return false;
+    
+    // these always go through the table (whatever setUseLUT says)
+    updateLUT(mesh, meshWidth, meshHeight, srcWidth, srcHeight, dstWidth, dstHeight);
+    
+    maskData = NULL;
+    if(mask.isEnabled()){
+        setupPool();
+        mask.update(mesh, meshWidth, meshHeight, dstWidth, dstHeight, &pool);
+        maskData = mask.getData();
+    }
+    
+    // and don't leave dst the way an incremental remap expects
+    lastDst = NULL;
+    
+    return true;
+}
+
+//--------------------------------------------------------------
+template<class T>
+void ofxBezierWarpRemap::remapPlane(const T * src, int srcWidth, int srcHeight, T * dst, int dstWidth, int dstHeight,
+                                    int numChannels, int subsample, const T * blank, int quantizeBits,
+                                    const unsigned char * mask, int numMasked, const T * src2, T * dst2){
+    
+    setupPool();
+    
+    PlaneJob<T> job;
+    job.lut = &lut;
+    job.src = src;
+    job.src2 = src2;
+    job.srcWidth = srcWidth;
+    job.srcHeight = srcHeight;
+    job.dst = dst;
+    job.dst2 = dst2;
+    job.dstWidth = dstWidth;
+    job.dstHeight = dstHeight;
+    job.numChannels = numChannels;
+    job.subsample = subsample;
+    job.blank = blank;
+    job.quantizeBits = quantizeBits;
+    job.mask = mask;
+    job.numMasked = numMasked;
+    
+    int numBands = getNumBands(dstHeight);
+    job.bandHeight = (dstHeight + numBands - 1) / numBands;
+    numBands = (dstHeight + job.bandHeight - 1) / job.bandHeight;
+    
+    pool.run(job, numBands);
+}
+
+//--------------------------------------------------------------
+template<class T>
+inline bool ofxBezierWarpRemap::PlaneJob<T>::getCoord(int x, int y, float & sx, float & sy){
+    
+    // float tables are read directly, the rest decode a pixel at a time
+    
+    if(coords == NULL) return lut->getCoord(x, y, sx, sy);
+    
+    const float * c = coords + (y * lut->getWidth() + x) * 2;
+    sx = c[0];
+    sy = c[1];
+    
+    return c[0] >= 0.0f;
+}
+
+//--------------------------------------------------------------
+template<class T>
+void ofxBezierWarpRemap::PlaneJob<T>::process(int band){
+    
+    int bandBegin = band * bandHeight;
+    int bandEnd = MIN(bandBegin + bandHeight, dstHeight);
+    
+    int lutWidth = lut->getWidth();
+    int lutHeight = lut->getHeight();
+    
+    coords = lut->getFormat() == OFX_BEZIER_WARP_LUT_FLOAT ? lut->getData() : NULL;
+    
+    for(int y = bandBegin; y < bandEnd; y++){
+        
+        T * out = dst + y * dstWidth * numChannels;
+        T * out2 = dst2 != NULL ? dst2 + y * dstWidth * numChannels : NULL;
+        
+        for(int x = 0; x < dstWidth; x++, out += numChannels){
+            
+            float sx = 0.0f, sy = 0.0f;
+            int numCovered = 0;
+            
+            if(subsample == 1){
+                numCovered = getCoord(x, y, sx, sy) ? 1 : 0;
+            }else{
+                // a subsampled pixel reads from halfway between the first
+                // and last full resolution pixels it covers (exact while the
+                // table is locally linear), scaled down to its own plane
+                int x0 = MIN(x * subsample, lutWidth - 1);
+                int y0 = MIN(y * subsample, lutHeight - 1);
+                int x1 = MIN(x0 + subsample - 1, lutWidth - 1);
+                int y1 = MIN(y0 + subsample - 1, lutHeight - 1);
+                float cx, cy;
+                if(getCoord(x0, y0, cx, cy)){
+                    sx += cx;
+                    sy += cy;
+                    numCovered++;
+                }
+                if(getCoord(x1, y1, cx, cy)){
+                    sx += cx;
+                    sy += cy;
+                    numCovered++;
+                }
+                if(numCovered > 0){
+                    sx /= numCovered * subsample;
+                    sy /= numCovered * subsample;
+                }
+            }
+            
+            T * second = out2 != NULL ? out2 + x * numChannels : NULL;
+            
+            if(numCovered == 0){
+                for(int c = 0; c < numChannels; c++) out[c] = blank[c];
+                if(second != NULL) for(int c = 0; c < numChannels; c++) second[c] = blank[c];
+                continue;
+            }
+            
+            sampleBilinearPlane(src, srcWidth, srcHeight, numChannels, sx, sy, out);
+            if(second != NULL) sampleBilinearPlane(src2, srcWidth, srcHeight, numChannels, sx, sy, second);
+            
+            if(mask != NULL){
+                // the mask is table sized so subsampled planes use their first pixel's
+                int m = mask[MIN(y * subsample, lutHeight - 1) * lutWidth + MIN(x * subsample, lutWidth - 1)];
+                for(int c = 0; c < numMasked; c++) maskSample(out[c], blank[c], m);
+                if(second != NULL) for(int c = 0; c < numMasked; c++) maskSample(second[c], blank[c], m);
+            }
+            
+            if(quantizeBits > 0){
+                for(int c = 0; c < numChannels; c++) quantizeSample(out[c], quantizeBits);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::setIncremental(bool b){
+    bIncremental = b;
+    lastDst = NULL;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpRemap::getIncremental(){
+    return bIncremental;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::addDirtyRect(ofRectangle rect){
+    if(rect.width <= 0 || rect.height <= 0) return;
+    dirtyRects.push_back(rect);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::clearDirtyRects(){
+    dirtyRects.clear();
+}
+
+//--------------------------------------------------------------
+vector<ofRectangle>& ofxBezierWarpRemap::getDirtyRectsReference(){
+    return dirtyRects;
+}
+
+//--------------------------------------------------------------
+vector<ofRectangle>& ofxBezierWarpRemap::getChangedRectsReference(){
+    return changedRects;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::updateFootprints(){
+    
+    if(footprintKey == lut.getKey() && footprints.size() > 0) return;
+    
+    FootprintJob job;
+    job.lut = &lut;
+    job.numBlocksX = (lut.getWidth() + blockWidth - 1) / blockWidth;
+    int numBlocksY = (lut.getHeight() + blockHeight - 1) / blockHeight;
+    
+    footprints.resize(job.numBlocksX * numBlocksY * 4);
+    job.footprints = &footprints[0];
+    
+    setupPool();
+    pool.run(job, job.numBlocksX * numBlocksY);
+    
+    footprintKey = lut.getKey();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::remapDirty(const unsigned char * src, unsigned char * dst, int numChannels, const unsigned char * maskData){
+    
+    changedRects.clear();
+    
+    if(dirtyRects.size() == 0) return;
+    
+    updateFootprints();
+    
+    int numBlocksX = (lut.getWidth() + blockWidth - 1) / blockWidth;
+    int numBlocks = footprints.size() / 4;
+    
+    // blocks that read any of the dirty source pixels
+    dirtyBlocks.clear();
+    
+    for(int b = 0; b < numBlocks; b++){
+        
+        const int * f = &footprints[b * 4];
+        if(f[2] < f[0]) continue;
+        
+        for(size_t i = 0; i < dirtyRects.size(); i++){
+            const ofRectangle & r = dirtyRects[i];
+            int x0 = floor(r.x), y0 = floor(r.y);
+            int x1 = ceil(r.x + r.width) - 1, y1 = ceil(r.y + r.height) - 1;
+            if(x0 <= f[2] && x1 >= f[0] && y0 <= f[3] && y1 >= f[1]){
+                dirtyBlocks.push_back(b);
+                break;
+            }
+        }
+    }
+    
+    gather(lut, src, dst, numChannels, 0, maskData, &dirtyBlocks);
+    
+    // runs of blocks along each block row, stacked with any matching run
+    // from the row above (the list is already in row order)
+    
+    size_t openBegin = 0;
+    
+    for(size_t k = 0; k < dirtyBlocks.size();){
+        
+        int row = dirtyBlocks[k] / numBlocksX;
+        int first = dirtyBlocks[k] % numBlocksX;
+        int last = first;
+        
+        while(k + 1 < dirtyBlocks.size() && dirtyBlocks[k + 1] == dirtyBlocks[k] + 1 && dirtyBlocks[k + 1] / numBlocksX == row){
+            last++;
+            k++;
+        }
+        k++;
+        
+        float x = first * blockWidth;
+        float y = row * blockHeight;
+        float w = MIN((last + 1) * blockWidth, lut.getWidth()) - x;
+        float h = MIN((row + 1) * blockHeight, lut.getHeight()) - y;
+        
+        bool bMerged = false;
+        
+        for(size_t i = openBegin; i < changedRects.size(); i++){
+            ofRectangle & r = changedRects[i];
+            if(r.x == x && r.width == w && r.y + r.height == y){
+                r.height += h;
+                bMerged = true;
+                break;
+            }
+        }
+        
+        if(!bMerged){
+            // rects that didn't reach the row above can't grow any more
+            while(openBegin < changedRects.size() && changedRects[openBegin].y + changedRects[openBegin].height < y) openBegin++;
+            changedRects.push_back(ofRectangle(x, y, w, h));
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::FootprintJob::process(int block){
+    
+    // bounding box of every source pixel the block's bilinear samples
+    // can touch (a pixel either side to be safe) - empty has max < min
+    
+    int x0 = (block % numBlocksX) * blockWidth;
+    int y0 = (block / numBlocksX) * blockHeight;
+    int x1 = MIN(x0 + blockWidth, lut->getWidth());
+    int y1 = MIN(y0 + blockHeight, lut->getHeight());
+    
+    float minX = 1e9, minY = 1e9, maxX = -1e9, maxY = -1e9;
+    
+    for(int y = y0; y < y1; y++){
+        for(int x = x0; x < x1; x++){
+            float sx, sy;
+            if(!lut->getCoord(x, y, sx, sy)) continue;
+            minX = MIN(minX, sx); maxX = MAX(maxX, sx);
+            minY = MIN(minY, sy); maxY = MAX(maxY, sy);
+        }
+    }
+    
+    int * f = &footprints[block * 4];
+    
+    if(maxX < minX){
+        f[0] = f[1] = 0;
+        f[2] = f[3] = -1;
+        return;
+    }
+    
+    f[0] = MAX(0, (int)floor(minX) - 1);
+    f[1] = MAX(0, (int)floor(minY) - 1);
+    f[2] = MIN(lut->getSourceWidth() - 1, (int)floor(maxX) + 1);
+    f[3] = MIN(lut->getSourceHeight() - 1, (int)floor(maxY) + 1);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::gather(ofxBezierWarpLUT & lut, const unsigned char * src, unsigned char * dst, int numChannels, int dstStride,
+                                const unsigned char * mask, const vector<int> * blocks){
+    
+    if(!lut.isAllocated() || src == NULL || dst == NULL) return;
+    
+    if(numChannels < 1 || numChannels > 4){
+        ofLogError() << "Can only remap 1 to 4 channel pixels";
+        return;
+    }
+    
+    setupPool();
+    
+    GatherJob job;
+    job.lut = &lut;
+    job.coords = lut.getData();
+    job.fixedCoords = lut.getFixedData();
+    job.fractionBits = lut.getFractionBits();
+    job.src = src;
+    job.srcWidth = lut.getSourceWidth();
+    job.srcHeight = lut.getSourceHeight();
+    job.dst = dst;
+    job.dstWidth = lut.getWidth();
+    job.dstHeight = lut.getHeight();
+    job.dstStride = dstStride > 0 ? dstStride : job.dstWidth;
+    job.mask = mask;
+    job.numChannels = numChannels;
+    job.kernel = blocks != NULL ? OFX_BEZIER_WARP_REMAP_TILED : kernel;
+    job.blocks = NULL;
+    
+    if(job.kernel == OFX_BEZIER_WARP_REMAP_TILED){
+        
+        job.blockWidth = blockWidth;
+        job.blockHeight = blockHeight;
+        job.numBlocksX = (job.dstWidth + job.blockWidth - 1) / job.blockWidth;
+        int numBlocksY = (job.dstHeight + job.blockHeight - 1) / job.blockHeight;
+        
+        if(blocks != NULL){
+            // just the listed ones
+            if(blocks->size() == 0) return;
+            job.blocks = &(*blocks)[0];
+            pool.run(job, blocks->size());
+        }else{
+            pool.run(job, job.numBlocksX * numBlocksY);
+        }
+        
+    }else{
+        
+        int numBands = getNumBands(job.dstHeight);
+        job.bandHeight = (job.dstHeight + numBands - 1) / numBands;
+        numBands = (job.dstHeight + job.bandHeight - 1) / job.bandHeight;
+        
+        pool.run(job, numBands);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::GatherJob::process(int task){
+    
+    if(kernel == OFX_BEZIER_WARP_REMAP_TILED){
+        
+        int block = blocks != NULL ? blocks[task] : task;
+        int x0 = (block % numBlocksX) * blockWidth;
+        int y0 = (block / numBlocksX) * blockHeight;
+        int x1 = MIN(x0 + blockWidth, dstWidth);
+        int y1 = MIN(y0 + blockHeight, dstHeight);
+        
+        prefetchFootprint(x0, y0, x1, y1);
+        
+        for(int y = y0; y < y1; y++) gatherRow(y, x0, x1, true);
+        
+    }else{
+        
+        int bandBegin = task * bandHeight;
+        int bandEnd = MIN(bandBegin + bandHeight, dstHeight);
+        
+        for(int y = bandBegin; y < bandEnd; y++) gatherRow(y, 0, dstWidth, false);
+    }
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpRemap::GatherJob::lookup(int x, int y, float & sx, float & sy){
+    
+    // source pixel a single output pixel maps to (for working out footprints)
+    
+    switch(lut->getFormat()){
+        case OFX_BEZIER_WARP_LUT_FLOAT:{
+            const float * c = coords + (y * dstWidth + x) * 2;
+            sx = c[0]; sy = c[1];
+            return c[0] >= 0.0f;
+        }
+        case OFX_BEZIER_WARP_LUT_FIXED16:{
+            const unsigned short * c = fixedCoords + (y * dstWidth + x) * 2;
+            sx = (float)c[0] / (1 << fractionBits); sy = (float)c[1] / (1 << fractionBits);
+            return c[0] != OFX_BEZIER_WARP_LUT_FIXED_INVALID;
+        }
+        case OFX_BEZIER_WARP_LUT_TILE_DELTA:{
+            int tileSize = OFX_BEZIER_WARP_LUT_TILE_SIZE;
+            int tileIndex = (y / tileSize) * lut->getNumTilesX() + x / tileSize;
+            int i = x % tileSize, j = y % tileSize;
+            const ofxBezierWarpLUT::Tile & tile = lut->getTilesReference()[tileIndex];
+            if(tile.rawOffset != -1) return false;
+            sx = (float)(tile.baseX + ((tile.stepXX * i + tile.stepYX * j) >> 8)) / (1 << fractionBits);
+            sy = (float)(tile.baseY + ((tile.stepXY * i + tile.stepYY * j) >> 8)) / (1 << fractionBits);
+            return true;
+        }
+    }
+    return false;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::GatherJob::prefetchFootprint(int x0, int y0, int x1, int y1){
+    
+    // warps are smooth so the corners of a block give a good idea of the
+    // source area it reads - pull that into cache before sampling it, as
+    // long as it's small enough not to push itself back out again
+    
+    int xs[4] = {x0, x1 - 1, x0, x1 - 1};
+    int ys[4] = {y0, y0, y1 - 1, y1 - 1};
+    
+    float minX = srcWidth, minY = srcHeight, maxX = 0, maxY = 0;
+    
+    for(int k = 0; k < 4; k++){
+        float sx, sy;
+        if(!lookup(xs[k], ys[k], sx, sy)) return;
+        minX = MIN(minX, sx); maxX = MAX(maxX, sx);
+        minY = MIN(minY, sy); maxY = MAX(maxY, sy);
+    }
+    
+    int left = MAX(0, (int)minX - 1);
+    int right = MIN(srcWidth - 1, (int)maxX + 1);
+    int top = MAX(0, (int)minY - 1);
+    int bottom = MIN(srcHeight - 1, (int)maxY + 1);
+    
+    int rowBytes = (right - left + 1) * numChannels;
+    if(rowBytes * (bottom - top + 1) > 128 * 1024) return;
+    
+    for(int y = top; y <= bottom; y++){
+        const unsigned char * row = src + (y * srcWidth + left) * numChannels;
+        for(int b = 0; b < rowBytes; b += 64) ofxBezierWarpPrefetch(row + b);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::GatherJob::gatherRow(int y, int xBegin, int xEnd, bool bUseSIMD){
+    
+    switch(lut->getFormat()){
+        case OFX_BEZIER_WARP_LUT_FLOAT:
+            gatherFloat(y, xBegin, xEnd, bUseSIMD);
+            break;
+        case OFX_BEZIER_WARP_LUT_FIXED16:
+            gatherFixed(y, xBegin, xEnd, bUseSIMD);
+            break;
+        case OFX_BEZIER_WARP_LUT_TILE_DELTA:
+            gatherTiles(y, xBegin, xEnd, bUseSIMD);
+            break;
+    }
+    
+    // while the row is still in cache
+    if(mask != NULL){
+        ofxBezierWarpMask::apply(dst + (y * dstStride + xBegin) * numChannels, mask + y * dstWidth + xBegin, xEnd - xBegin, numChannels);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::GatherJob::gatherFloat(int y, int xBegin, int xEnd, bool bUseSIMD){
+    const float * c = coords + (y * dstWidth + xBegin) * 2;
+    unsigned char * out = dst + (y * dstStride + xBegin) * numChannels;
+    for(int x = xBegin; x < xEnd; x++, c += 2, out += numChannels){
+        if(c[0] < 0.0f){
+            for(int k = 0; k < numChannels; k++) out[k] = 0;
+        }else{
+            sampleBilinear(src, srcWidth, srcHeight, numChannels, c[0], c[1], out, bUseSIMD);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::GatherJob::gatherFixed(int y, int xBegin, int xEnd, bool bUseSIMD){
+    const unsigned short * c = fixedCoords + (y * dstWidth + xBegin) * 2;
+    unsigned char * out = dst + (y * dstStride + xBegin) * numChannels;
+    for(int x = xBegin; x < xEnd; x++, c += 2, out += numChannels){
+        if(c[0] == OFX_BEZIER_WARP_LUT_FIXED_INVALID){
+            for(int k = 0; k < numChannels; k++) out[k] = 0;
+        }else{
+            sampleBilinearFixed(src, srcWidth, srcHeight, numChannels, c[0], c[1], fractionBits, out, bUseSIMD);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::GatherJob::gatherTiles(int y, int xBegin, int xEnd, bool bUseSIMD){
+    
+    // xBegin and xEnd are either the whole row or block edges, which
+    // are always on LUT tile boundaries (or the end of the row)
+    
+    int tileSize = OFX_BEZIER_WARP_LUT_TILE_SIZE;
+    int numTilesX = lut->getNumTilesX();
+    int tileY = y / tileSize;
+    int j = y % tileSize;
+    int tileXBegin = xBegin / tileSize;
+    int tileXEnd = (xEnd + tileSize - 1) / tileSize;
+    
+    const vector<ofxBezierWarpLUT::Tile>& tiles = lut->getTilesReference();
+    const vector<signed char>& residuals = lut->getResidualsReference();
+    const vector<int>& raw = lut->getRawReference();
+    
+    unsigned char * out = dst + (y * dstStride + tileXBegin * tileSize) * numChannels;
+    
+    for(int tileX = tileXBegin; tileX < tileXEnd; tileX++){
+        
+        const ofxBezierWarpLUT::Tile & tile = tiles[tileY * numTilesX + tileX];
+        int w = MIN(tileSize, dstWidth - tileX * tileSize);
+        
+        if(tile.rawOffset == -2){
+            memset(out, 0, w * numChannels);
+        }else if(tile.rawOffset >= 0){
+            const int * c = &raw[tile.rawOffset + j * tileSize * 2];
+            for(int i = 0; i < w; i++){
+                if(c[i*2] < 0){
+                    for(int k = 0; k < numChannels; k++) out[i * numChannels + k] = 0;
+                }else{
+                    sampleBilinearFixed(src, srcWidth, srcHeight, numChannels, c[i*2], c[i*2+1], fractionBits, out + i * numChannels, bUseSIMD);
+                }
+            }
+        }else{
+            const signed char * r = &residuals[((tileY * numTilesX + tileX) * tileSize + j) * tileSize * 2];
+            int accX = tile.stepYX * j;
+            int accY = tile.stepYY * j;
+            for(int i = 0; i < w; i++, accX += tile.stepXX, accY += tile.stepXY){
+                if(r[i*2] == OFX_BEZIER_WARP_LUT_RESIDUAL_INVALID){
+                    for(int k = 0; k < numChannels; k++) out[i * numChannels + k] = 0;
+                }else{
+                    int cx = tile.baseX + (accX >> 8) + r[i*2];
+                    int cy = tile.baseY + (accY >> 8) + r[i*2+1];
+                    sampleBilinearFixed(src, srcWidth, srcHeight, numChannels, cx, cy, fractionBits, out + i * numChannels, bUseSIMD);
+                }
+            }
+        }
+        
+        out += w * numChannels;
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::RasterJob::process(int band){
+    
+    int bandBegin = band * bandHeight;
+    int bandEnd = MIN(bandBegin + bandHeight, dstHeight);
+    
+    ofxBezierWarpRasterizeMesh(*mesh, scaleX, scaleY, dstWidth, bandBegin, bandEnd, *this);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpRemap::RasterJob::operator()(int x, int y, float u, float v){
+    unsigned char * out = dst + (y * dstWidth + x) * numChannels;
+    sampleBilinear(src, srcWidth, srcHeight, numChannels, srcRect.x + u * srcRect.width, srcRect.y + v * srcRect.height, out);
+    if(mask != NULL) ofxBezierWarpMask::apply(out, mask + y * dstWidth + x, 1, numChannels);
+}
@@ -0,0 +1,309 @@
+/*
+ * ofxBezierWarpRemap.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPREMAP
+#define _H_OFXBEZIERWARPREMAP
+
+#include "ofPixels.h"
+#include "ofxBezierWarp.h"
+#include "ofxBezierWarpThreadPool.h"
+#include "ofxBezierWarpLUT.h"
+#include "ofxBezierWarpMask.h"
+
+enum ofxBezierWarpRemapKernel {
+    OFX_BEZIER_WARP_REMAP_ROWS = 0,     // plain row bands in scalar code - the reference version
+    OFX_BEZIER_WARP_REMAP_TILED         // cache sized blocks, source footprint prefetch and SIMD bilinear
+};
+
+// 4:2:0 video frames, tightly packed with the luma plane first
+enum ofxBezierWarpYUVFormat {
+    OFX_BEZIER_WARP_YUV_I420 = 0,       // 8 bit Y, U and V planes
+    OFX_BEZIER_WARP_YUV_NV12,           // 8 bit Y plane then interleaved UV
+    OFX_BEZIER_WARP_YUV_P010            // like NV12 with 16 bit samples holding 10 bits at the top
+};
+
+// software version of ofxBezierWarp::draw() - rasterizes the warp mesh
+// into a pixel buffer and bilinearly samples the source for every pixel
+// it covers. The output is split into row bands across a thread pool so
+// it runs headless (render farms, CI) and gives a reference to compare
+// against what the GL path draws
+//
+// by default the rasterized source coordinates are kept in a lookup table
+// which is only rebuilt when the warp changes (and can be cached on disk)
+// so most frames are a straight gather from the source
+
+class ofxBezierWarpRemap {
+    
+public:
+	
+    ofxBezierWarpRemap();
+    ~ofxBezierWarpRemap();
+    
+    void setNumThreads(int numThreads);
+    int getNumThreads();
+    
+    // how LUT gathers walk the output - both agree to within rounding
+    void setKernel(ofxBezierWarpRemapKernel kernel);
+    ofxBezierWarpRemapKernel getKernel();
+    
+    void setUseLUT(bool b);
+    bool getUseLUT();
+    
+    // directory LUTs are saved to and loaded from - empty to disable
+    void setLUTCacheDirectory(string path);
+    string getLUTCacheDirectory();
+    
+    ofxBezierWarpLUT& getLUT();
+    
+    // blend/brightness mask multiplied in while remapping, when it's enabled
+    ofxBezierWarpMask& getMask();
+    
+    // incremental remaps only gather the output blocks that read from
+    // source pixels marked dirty since the last remap (the warp's own dirty
+    // rects are picked up too) - no dirty rects means nothing is redone.
+    // Anything that changes the table, mask or dst redoes the whole lot
+    void setIncremental(bool b);
+    bool getIncremental();
+    
+    // in source pixels
+    void addDirtyRect(ofRectangle rect);
+    void clearDirtyRects();
+    vector<ofRectangle>& getDirtyRectsReference();
+    
+    // output rects the last remap wrote to (eg., for partial encoder updates)
+    vector<ofRectangle>& getChangedRectsReference();
+    
+    // dst is allocated at the warp size if it isn't already
+    void remap(ofxBezierWarp & warp, const ofPixels & src, ofPixels & dst);
+    
+    // src and dst must have the same number of channels (1 to 4) and be
+    // tightly packed - dst is drawn at dstWidth x dstHeight the same way
+    // draw(0, 0, dstWidth, dstHeight) scales the warp
+    void remap(ofxBezierWarp & warp, const unsigned char * src, int srcWidth, int srcHeight,
+               unsigned char * dst, int dstWidth, int dstHeight, int numChannels);
+    
+    void remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+               const unsigned char * src, int srcWidth, int srcHeight,
+               unsigned char * dst, int dstWidth, int dstHeight, int numChannels);
+    
+    // only reads sourceRect (in pixels) of a bigger shared source - like
+    // the GL path edge pixels still filter with whatever is next to them
+    void remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+               const unsigned char * src, int srcWidth, int srcHeight,
+               unsigned char * dst, int dstWidth, int dstHeight, int numChannels);
+    
+    // 16 bit and float pixels (1 to 4 channels) through the same table
+    void remap(ofxBezierWarp & warp, const ofShortPixels & src, ofShortPixels & dst);
+    void remap(ofxBezierWarp & warp, const ofFloatPixels & src, ofFloatPixels & dst);
+    
+    void remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+               const unsigned short * src, int srcWidth, int srcHeight,
+               unsigned short * dst, int dstWidth, int dstHeight, int numChannels);
+    void remap(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+               const float * src, int srcWidth, int srcHeight,
+               float * dst, int dstWidth, int dstHeight, int numChannels);
+    
+    // warps video frames plane by plane without going through RGB - the
+    // table is built for the luma plane and chroma is sampled at its own
+    // resolution. Uncovered pixels come out black (zero luma, mid chroma).
+    // src and dst are getYUVSize() bytes
+    void remapYUV(ofxBezierWarp & warp, ofxBezierWarpYUVFormat format, const unsigned char * src, int srcWidth, int srcHeight,
+                  unsigned char * dst, int dstWidth, int dstHeight);
+    void remapYUV(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofxBezierWarpYUVFormat format,
+                  const unsigned char * src, int srcWidth, int srcHeight,
+                  unsigned char * dst, int dstWidth, int dstHeight);
+    
+    static int getYUVSize(ofxBezierWarpYUVFormat format, int width, int height);
+    
+    // gather through an already built table - dstStride (in pixels) is for
+    // writing into part of a bigger image, 0 means the table width, and
+    // mask (the size of the table) is applied to each row as it's gathered
+    void remap(ofxBezierWarpLUT & lut, const unsigned char * src, unsigned char * dst, int numChannels, int dstStride = 0,
+               const unsigned char * mask = NULL);
+    
+    void updateLUT(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                   int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    void updateLUT(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                   int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    
+    // builds someone else's table on our threads (eg., one per warp)
+    void buildLUT(ofxBezierWarpLUT & table, ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight, ofRectangle sourceRect,
+                  int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    
+    ofxBezierWarpThreadPool& getThreadPool();
+    
+protected:
+	
+    void setupPool();
+    int getNumBands(int height);
+    
+    void gather(ofxBezierWarpLUT & lut, const unsigned char * src, unsigned char * dst, int numChannels, int dstStride,
+                const unsigned char * mask, const vector<int> * blocks);
+    void remapDirty(const unsigned char * src, unsigned char * dst, int numChannels, const unsigned char * mask);
+    void updateFootprints();
+    
+    // maskData is set to the mask to apply (NULL when it's off)
+    bool prepareLUT(ofxBezierWarpMesh & mesh, float meshWidth, float meshHeight,
+                    int srcWidth, int srcHeight, int dstWidth, int dstHeight, int numChannels,
+                    const unsigned char *& maskData);
+    
+    // mask (the size of the table) scales the first numMasked channels
+    // towards blank. src2/dst2 is an optional second plane of the same size
+    // read from the same positions (eg., I420's V plane along with U)
+    template<class T>
+    void remapPlane(const T * src, int srcWidth, int srcHeight, T * dst, int dstWidth, int dstHeight,
+                    int numChannels, int subsample, const T * blank, int quantizeBits = 0,
+                    const unsigned char * mask = NULL, int numMasked = 0, const T * src2 = NULL, T * dst2 = NULL);
+    
+    // the 8 bit remaps with the table in any format are specialised (and
+    // SIMD) - other sample types and half resolution chroma planes go
+    // through this, reading float source positions from the table
+    template<class T>
+    class PlaneJob : public ofxBezierWarpJob {
+    public:
+        void process(int band);
+        bool getCoord(int x, int y, float & sx, float & sy);
+        ofxBezierWarpLUT * lut;
+        const float * coords;
+        const T * src;
+        const T * src2;
+        int srcWidth;
+        int srcHeight;
+        T * dst;
+        T * dst2;
+        int dstWidth;
+        int dstHeight;
+        int numChannels;
+        int subsample;
+        const T * blank;
+        int quantizeBits;
+        const unsigned char * mask;
+        int numMasked;
+        int bandHeight;
+    };
+    
+    class RasterJob : public ofxBezierWarpJob {
+    public:
+        void process(int band);
+        void operator()(int x, int y, float u, float v);
+        ofxBezierWarpMesh * mesh;
+        float scaleX;
+        float scaleY;
+        const unsigned char * src;
+        int srcWidth;
+        int srcHeight;
+        ofRectangle srcRect;
+        unsigned char * dst;
+        int dstWidth;
+        int dstHeight;
+        const unsigned char * mask;
+        int numChannels;
+        int bandHeight;
+    };
+    
+    class GatherJob : public ofxBezierWarpJob {
+    public:
+        void process(int task);
+        bool lookup(int x, int y, float & sx, float & sy);
+        void prefetchFootprint(int x0, int y0, int x1, int y1);
+        void gatherRow(int y, int xBegin, int xEnd, bool bUseSIMD);
+        void gatherFloat(int y, int xBegin, int xEnd, bool bUseSIMD);
+        void gatherFixed(int y, int xBegin, int xEnd, bool bUseSIMD);
+        void gatherTiles(int y, int xBegin, int xEnd, bool bUseSIMD);
+        ofxBezierWarpRemapKernel kernel;
+        const int * blocks;
+        int blockWidth;
+        int blockHeight;
+        int numBlocksX;
+        ofxBezierWarpLUT * lut;
+        const float * coords;
+        const unsigned short * fixedCoords;
+        int fractionBits;
+        const unsigned char * src;
+        int srcWidth;
+        int srcHeight;
+        unsigned char * dst;
+        int dstWidth;
+        int dstHeight;
+        int dstStride;
+        const unsigned char * mask;
+        int numChannels;
+        int bandHeight;
+    };
+    
+    class FootprintJob : public ofxBezierWarpJob {
+    public:
+        void process(int block);
+        ofxBezierWarpLUT * lut;
+        int numBlocksX;
+        int * footprints;
+    };
+    
+    ofxBezierWarpThreadPool pool;
+    int numThreads;
+    bool bPoolSetup;
+    
+    ofxBezierWarpRemapKernel kernel;
+    
+    bool bUseLUT;
+    string lutCacheDirectory;
+    
+    ofxBezierWarpLUT lut;
+    ofxBezierWarpMesh * lutMesh;
+    unsigned int lutMeshVersion;
+    float lutMeshWidth;
+    float lutMeshHeight;
+    ofRectangle lutSourceRect;
+    
+    ofxBezierWarpMask mask;
+    
+    bool bIncremental;
+    vector<ofRectangle> dirtyRects;
+    vector<ofRectangle> changedRects;
+    vector<int> dirtyBlocks;
+    
+    // source bounds (min x, min y, max x, max y) of each output block
+    vector<int> footprints;
+    unsigned long long footprintKey;
+    
+    // what dst holds after the last remap
+    unsigned long long lastKey;
+    unsigned char * lastDst;
+    int lastNumChannels;
+    const unsigned char * lastMask;
+    
+private:
+	
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ * ofxBezierWarpSIMD.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPSIMD
+#define _H_OFXBEZIERWARPSIMD
+
+// small set of SIMD kernels shared by the CPU evaluator and remap code
+//
+// every kernel has a scalar version that does the same multiplies and
+// adds in the same order, so the two paths agree to within rounding.
+// Don't count on them being bit identical: once FMA is enabled (eg.,
+// -march=native on anything recent) GCC fuses multiply-adds by default
+// (-ffp-contract=fast), in the scalar code and the intrinsics alike, and
+// not always in the same places. The integer kernels are exact either way
+//
+// define OFX_BEZIER_WARP_NO_SIMD to force the scalar versions everywhere
+
+#ifndef OFX_BEZIER_WARP_NO_SIMD
+    #if defined(__AVX__)
+        #define OFX_BEZIER_WARP_AVX
+        #define OFX_BEZIER_WARP_SSE
+        #include <immintrin.h>
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        // the pixel kernels need the SSE2 integer ops, so plain SSE isn't enough
+        #define OFX_BEZIER_WARP_SSE
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+        #define OFX_BEZIER_WARP_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#include <cstring>
+
+//--------------------------------------------------------------
+// dst[k] = dst[k] + w * src[k]
+static inline void ofxBezierWarpAxpyScalar(float * dst, const float * src, float w, int count){
+    for(int k = 0; k < count; k++){
+        float p = w * src[k];
+        dst[k] = dst[k] + p;
+    }
+}
+
+//--------------------------------------------------------------
+static inline void ofxBezierWarpAxpy(float * dst, const float * src, float w, int count){
+    
+    int k = 0;
+    
+#if defined(OFX_BEZIER_WARP_AVX)
+    __m256 w8 = _mm256_set1_ps(w);
+    for(; k + 8 <= count; k += 8){
+        __m256 p = _mm256_mul_ps(w8, _mm256_loadu_ps(src + k));
+        _mm256_storeu_ps(dst + k, _mm256_add_ps(_mm256_loadu_ps(dst + k), p));
+    }
+#endif
+    
+#if defined(OFX_BEZIER_WARP_SSE)
+    __m128 w4 = _mm_set1_ps(w);
+    for(; k + 4 <= count; k += 4){
+        __m128 p = _mm_mul_ps(w4, _mm_loadu_ps(src + k));
+        _mm_storeu_ps(dst + k, _mm_add_ps(_mm_loadu_ps(dst + k), p));
+    }
+#elif defined(OFX_BEZIER_WARP_NEON)
+    float32x4_t w4 = vdupq_n_f32(w);
+    for(; k + 4 <= count; k += 4){
+        float32x4_t p = vmulq_f32(w4, vld1q_f32(src + k));
+        vst1q_f32(dst + k, vaddq_f32(vld1q_f32(dst + k), p));
+    }
+#endif
+    
+    ofxBezierWarpAxpyScalar(dst + k, src + k, w, count - k);
+}
+
+//--------------------------------------------------------------
+// 4 byte pixel loads/stores through memcpy so they're safe unaligned
+static inline int ofxBezierWarpLoadPixel(const unsigned char * p){
+    int v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//--------------------------------------------------------------
+static inline void ofxBezierWarpStorePixel(unsigned char * p, int v){
+    memcpy(p, &v, sizeof(v));
+}
+
+//--------------------------------------------------------------
+// bilinear blend of 4 neighbouring pixels with float weights
+static inline void ofxBezierWarpBilinearScalar(const unsigned char * p00, const unsigned char * p10,
+                                               const unsigned char * p01, const unsigned char * p11,
+                                               float fx, float fy, unsigned char * out, int numChannels){
+    for(int c = 0; c < numChannels; c++){
+        float top = p00[c] + (p10[c] - p00[c]) * fx;
+        float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+        out[c] = (unsigned char)(top + (bottom - top) * fy + 0.5f);
+    }
+}
+
+//--------------------------------------------------------------
+// same as above for 4 channel pixels with all channels done at once
+static inline void ofxBezierWarpBilinearRGBA(const unsigned char * p00, const unsigned char * p10,
+                                             const unsigned char * p01, const unsigned char * p11,
+                                             float fx, float fy, unsigned char * out){
+    
+#if defined(OFX_BEZIER_WARP_SSE)
+    __m128i zero = _mm_setzero_si128();
+    __m128 a = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p00)), zero), zero));
+    __m128 b = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p10)), zero), zero));
+    __m128 c = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p01)), zero), zero));
+    __m128 d = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p11)), zero), zero));
+    __m128 wx = _mm_set1_ps(fx);
+    __m128 wy = _mm_set1_ps(fy);
+    __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), wx));
+    __m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), wx));
+    __m128 v = _mm_add_ps(_mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), wy)), _mm_set1_ps(0.5f));
+    __m128i i = _mm_cvttps_epi32(v);
+    i = _mm_packus_epi16(_mm_packs_epi32(i, zero), zero);
+    ofxBezierWarpStorePixel(out, _mm_cvtsi128_si32(i));
+#elif defined(OFX_BEZIER_WARP_NEON)
+    float32x4_t a = vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_s32(vdup_n_s32(ofxBezierWarpLoadPixel(p00)))))));
+    float32x4_t b = vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_s32(vdup_n_s32(ofxBezierWarpLoadPixel(p10)))))));
+    float32x4_t c = vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_s32(vdup_n_s32(ofxBezierWarpLoadPixel(p01)))))));
+    float32x4_t d = vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_s32(vdup_n_s32(ofxBezierWarpLoadPixel(p11)))))));
+    float32x4_t wx = vdupq_n_f32(fx);
+    float32x4_t wy = vdupq_n_f32(fy);
+    float32x4_t top = vaddq_f32(a, vmulq_f32(vsubq_f32(b, a), wx));
+    float32x4_t bottom = vaddq_f32(c, vmulq_f32(vsubq_f32(d, c), wx));
+    float32x4_t v = vaddq_f32(vaddq_f32(top, vmulq_f32(vsubq_f32(bottom, top), wy)), vdupq_n_f32(0.5f));
+    uint8x8_t i = vmovn_u16(vcombine_u16(vmovn_u32(vcvtq_u32_f32(v)), vdup_n_u16(0)));
+    ofxBezierWarpStorePixel(out, vget_lane_s32(vreinterpret_s32_u8(i), 0));
+#else
+    ofxBezierWarpBilinearScalar(p00, p10, p01, p11, fx, fy, out, 4);
+#endif
+}
+
+//--------------------------------------------------------------
+// bilinear blend with integer weights in [0, 1 << fractionBits]
+static inline void ofxBezierWarpBilinearFixedScalar(const unsigned char * p00, const unsigned char * p10,
+                                                    const unsigned char * p01, const unsigned char * p11,
+                                                    int fx, int fy, int fractionBits, unsigned char * out, int numChannels){
+    int one = 1 << fractionBits;
+    int shift = fractionBits * 2;
+    int round = (1 << shift) >> 1;
+    for(int c = 0; c < numChannels; c++){
+        int top = p00[c] * (one - fx) + p10[c] * fx;
+        int bottom = p01[c] * (one - fx) + p11[c] * fx;
+        out[c] = (top * (one - fy) + bottom * fy + round) >> shift;
+    }
+}
+
+//--------------------------------------------------------------
+static inline void ofxBezierWarpBilinearFixedRGBA(const unsigned char * p00, const unsigned char * p10,
+                                                  const unsigned char * p01, const unsigned char * p11,
+                                                  int fx, int fy, int fractionBits, unsigned char * out){
+    
+#if defined(OFX_BEZIER_WARP_SSE)
+    // interleave the left/right pixels so _mm_madd_epi16 does a whole
+    // row's weighted sum per channel - the row sums only fit 16 bits
+    // for up to 7 fraction bits so 8 bits uses the scalar version
+    if(fractionBits < 8){
+        int one = 1 << fractionBits;
+        int shift = fractionBits * 2;
+        __m128i zero = _mm_setzero_si128();
+        __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p00)), zero);
+        __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p10)), zero);
+        __m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p01)), zero);
+        __m128i d = _mm_unpacklo_epi8(_mm_cvtsi32_si128(ofxBezierWarpLoadPixel(p11)), zero);
+        __m128i wx = _mm_set1_epi32(((fx & 0xFFFF) << 16) | (one - fx));
+        __m128i wy = _mm_set1_epi32(((fy & 0xFFFF) << 16) | (one - fy));
+        __m128i top = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), wx);
+        __m128i bottom = _mm_madd_epi16(_mm_unpacklo_epi16(c, d), wx);
+        __m128i rows = _mm_packs_epi32(top, bottom);
+        __m128i v = _mm_madd_epi16(_mm_unpacklo_epi16(rows, _mm_unpackhi_epi64(rows, rows)), wy);
+        v = _mm_srl_epi32(_mm_add_epi32(v, _mm_set1_epi32((1 << shift) >> 1)), _mm_cvtsi32_si128(shift));
+        v = _mm_packus_epi16(_mm_packs_epi32(v, zero), zero);
+        ofxBezierWarpStorePixel(out, _mm_cvtsi128_si32(v));
+        return;
+    }
+#endif
+    ofxBezierWarpBilinearFixedScalar(p00, p10, p01, p11, fx, fy, fractionBits, out, 4);
+}
+
+//--------------------------------------------------------------
+static inline void ofxBezierWarpPrefetch(const void * address){
+#if defined(OFX_BEZIER_WARP_SSE)
+    _mm_prefetch((const char *)address, _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(address);
+#endif
+}
+
+#endif
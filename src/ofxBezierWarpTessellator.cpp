@@ -0,0 +1,288 @@
+/*
+ * ofxBezierWarpTessellator.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#include "ofxBezierWarpTessellator.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpTessellator::ofxBezierWarpTessellator(){
+    front = 0;
+    ready = 1;
+    back = 2;
+    bRunning = false;
+    bPending = false;
+    bBuilding = false;
+    bReady = false;
+    numPublished = 0;
+    pending.numXPoints = pending.numYPoints = 0;
+    pending.gridDivX = pending.gridDivY = 0;
+    pending.mode = OFX_BEZIER_WARP_BEZIER;
+    pending.bAdaptive = false;
+    pending.tolerance = 0.5f;
+    
+    // whatever a new mesh starts with
+    ofxBezierWarpMesh defaults;
+    pending.bUseSIMD = defaults.getUseSIMD();
+    pending.bUseFixedEvaluators = defaults.getUseFixedEvaluators();
+    pending.indexOutput = defaults.getIndexOutput();
+    pending.bUseShortIndices = defaults.getUseShortIndices();
+    pending.bUsePrimitiveRestart = defaults.getUsePrimitiveRestart();
+    pending.vertexCacheSize = defaults.getVertexCacheSize();
+    pending.meshWidth = pending.meshHeight = 0;
+    pending.srcWidth = pending.srcHeight = 0;
+    pending.dstWidth = pending.dstHeight = 0;
+    pending.lutFormat = OFX_BEZIER_WARP_LUT_FLOAT;
+    pending.lutFractionBits = 4;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpTessellator::~ofxBezierWarpTessellator(){
+    stop();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::start(){
+    if(bRunning) return;
+    bRunning = true;
+    startThread(true, false);
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::stop(){
+    
+    if(!bRunning) return;
+    
+    swapMutex.lock();
+    bRunning = false;
+    swapMutex.unlock();
+    workCondition.broadcast();
+    
+    waitForThread(true);
+    
+    // anything asked for but not built is dropped
+    bPending = false;
+    bBuilding = false;
+    doneCondition.broadcast();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::update(const vector<GLfloat>& cntrlPoints, int numXPoints, int numYPoints, int gridDivX, int gridDivY,
+                                      ofxBezierWarpMode mode, bool bAdaptive, float tolerance,
+                                      const ofxBezierWarpLattice * lattice){
+    
+    swapMutex.lock();
+    
+    unsigned int latticeVersion = lattice != NULL ? lattice->getVersion() : 0;
+    
+    bool bChanged = (pending.numXPoints != numXPoints || pending.numYPoints != numYPoints ||
+                     pending.gridDivX != gridDivX || pending.gridDivY != gridDivY || pending.mode != mode ||
+                     pending.bAdaptive != bAdaptive || pending.tolerance != tolerance ||
+                     pending.lattice.getVersion() != latticeVersion ||
+                     pending.cntrlPoints.size() != cntrlPoints.size() ||
+                     (cntrlPoints.size() > 0 && memcmp(&pending.cntrlPoints[0], &cntrlPoints[0], cntrlPoints.size() * sizeof(GLfloat)) != 0));
+    
+    if(bChanged){
+        pending.cntrlPoints = cntrlPoints;
+        pending.lattice = lattice != NULL ? *lattice : ofxBezierWarpLattice();
+        pending.numXPoints = numXPoints;
+        pending.numYPoints = numYPoints;
+        pending.gridDivX = gridDivX;
+        pending.gridDivY = gridDivY;
+        pending.mode = mode;
+        pending.bAdaptive = bAdaptive;
+        pending.tolerance = tolerance;
+        bPending = true;
+    }
+    
+    swapMutex.unlock();
+    
+    if(bChanged) workCondition.signal();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::setMeshOptions(bool bUseSIMD, bool bUseFixedEvaluators, ofxBezierWarpIndexOutput indexOutput,
+                                              bool bUseShortIndices, bool bUsePrimitiveRestart, int vertexCacheSize){
+    
+    swapMutex.lock();
+    
+    bool bChanged = (pending.bUseSIMD != bUseSIMD || pending.bUseFixedEvaluators != bUseFixedEvaluators ||
+                     pending.indexOutput != indexOutput || pending.bUseShortIndices != bUseShortIndices ||
+                     pending.bUsePrimitiveRestart != bUsePrimitiveRestart || pending.vertexCacheSize != vertexCacheSize);
+    
+    if(bChanged){
+        pending.bUseSIMD = bUseSIMD;
+        pending.bUseFixedEvaluators = bUseFixedEvaluators;
+        pending.indexOutput = indexOutput;
+        pending.bUseShortIndices = bUseShortIndices;
+        pending.bUsePrimitiveRestart = bUsePrimitiveRestart;
+        pending.vertexCacheSize = vertexCacheSize;
+        bPending = true;
+    }
+    
+    swapMutex.unlock();
+    
+    if(bChanged) workCondition.signal();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::setLUT(float meshWidth, float meshHeight, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                                      ofxBezierWarpLUTFormat format, int fractionBits){
+    
+    swapMutex.lock();
+    pending.meshWidth = meshWidth;
+    pending.meshHeight = meshHeight;
+    pending.srcWidth = srcWidth;
+    pending.srcHeight = srcHeight;
+    pending.dstWidth = dstWidth;
+    pending.dstHeight = dstHeight;
+    pending.lutFormat = format;
+    pending.lutFractionBits = fractionBits;
+    bPending = true;
+    swapMutex.unlock();
+    
+    workCondition.signal();
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMesh& ofxBezierWarpTessellator::getMesh(){
+    
+    // if the worker happens to be handing over a mesh right now
+    // just draw the current one again rather than waiting for it
+    
+    if(swapMutex.tryLock()){
+        if(bReady){
+            int t = front;
+            front = ready;
+            ready = t;
+            bReady = false;
+        }
+        swapMutex.unlock();
+    }
+    
+    return slots[front].mesh;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLUT& ofxBezierWarpTessellator::getLUT(){
+    return slots[front].lut;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::flush(){
+    swapMutex.lock();
+    while(bRunning && (bPending || bBuilding)) doneCondition.wait(swapMutex);
+    swapMutex.unlock();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpTessellator::isBusy(){
+    swapMutex.lock();
+    bool bBusy = bPending || bBuilding;
+    swapMutex.unlock();
+    return bBusy;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxBezierWarpTessellator::getNumPublished(){
+    swapMutex.lock();
+    unsigned int n = numPublished;
+    swapMutex.unlock();
+    return n;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::threadedFunction(){
+    
+    while(isThreadRunning()){
+        
+        swapMutex.lock();
+        while(bRunning && !bPending) workCondition.wait(swapMutex);
+        if(!bRunning){
+            swapMutex.unlock();
+            break;
+        }
+        
+        // only ever build the latest request - anything that came
+        // in while the last one was building has been overwritten
+        building = pending;
+        bPending = false;
+        bBuilding = true;
+        swapMutex.unlock();
+        
+        build(building, slots[back]);
+        
+        swapMutex.lock();
+        int t = back;
+        back = ready;
+        ready = t;
+        bReady = true;
+        bBuilding = false;
+        numPublished++;
+        swapMutex.unlock();
+        
+        doneCondition.broadcast();
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTessellator::build(const Request & request, Slot & slot){
+    
+    // the back mesh is a couple of versions behind but update() works
+    // out what changed against its own copy of the net so it still
+    // only re-evaluates what it has to
+    
+    slot.mesh.setAdaptive(request.bAdaptive, request.tolerance);
+    slot.mesh.setUseSIMD(request.bUseSIMD);
+    slot.mesh.setUseFixedEvaluators(request.bUseFixedEvaluators);
+    slot.mesh.setIndexOutput(request.indexOutput);
+    slot.mesh.setUseShortIndices(request.bUseShortIndices);
+    slot.mesh.setUsePrimitiveRestart(request.bUsePrimitiveRestart);
+    slot.mesh.setVertexCacheSize(request.vertexCacheSize);
+    slot.mesh.update(request.cntrlPoints, request.numXPoints, request.numYPoints,
+                     request.gridDivX, request.gridDivY, request.mode, &request.lattice);
+    
+    if(request.dstWidth <= 0 || request.dstHeight <= 0 || !slot.mesh.isAllocated()){
+        slot.lut.clear();
+        return;
+    }
+    
+    slot.lut.setFormat(request.lutFormat, request.lutFractionBits);
+    
+    unsigned long long key = ofxBezierWarpLUT::makeKey(slot.mesh, request.meshWidth, request.meshHeight,
+                                                       request.srcWidth, request.srcHeight,
+                                                       request.dstWidth, request.dstHeight,
+                                                       request.lutFormat, request.lutFractionBits);
+    
+    if(slot.lut.isAllocated() && slot.lut.getKey() == key) return;
+    
+    slot.lut.build(slot.mesh, request.meshWidth, request.meshHeight,
+                   request.srcWidth, request.srcHeight, request.dstWidth, request.dstHeight);
+}
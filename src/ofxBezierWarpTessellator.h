@@ -0,0 +1,141 @@
+/*
+ * ofxBezierWarpTessellator.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#ifndef _H_OFXBEZIERWARPTESSELLATOR
+#define _H_OFXBEZIERWARPTESSELLATOR
+
+#include "ofThread.h"
+#include "Poco/Condition.h"
+#include "ofxBezierWarpMesh.h"
+#include "ofxBezierWarpLUT.h"
+
+// evaluates the warp mesh (and optionally a remap LUT) on a background
+// thread so dragging control points on big grids never stalls drawing.
+// Meshes are triple buffered: the worker builds into the back one, hands
+// it over as ready, and getMesh() swaps the newest ready one to the front
+// without ever waiting for the worker to finish
+
+class ofxBezierWarpTessellator : public ofThread {
+    
+public:
+	
+    ofxBezierWarpTessellator();
+    ~ofxBezierWarpTessellator();
+    
+    void start();
+    void stop();
+    
+    // copies the settings and wakes the worker if anything changed
+    void update(const vector<GLfloat>& cntrlPoints, int numXPoints, int numYPoints, int gridDivX, int gridDivY,
+                ofxBezierWarpMode mode = OFX_BEZIER_WARP_BEZIER, bool bAdaptive = false, float tolerance = 0.5f,
+                const ofxBezierWarpLattice * lattice = NULL);
+    
+    // the mesh's evaluation and draw index settings - every slot's mesh
+    // gets them before it's built so they survive the swaps
+    void setMeshOptions(bool bUseSIMD, bool bUseFixedEvaluators, ofxBezierWarpIndexOutput indexOutput,
+                        bool bUseShortIndices, bool bUsePrimitiveRestart, int vertexCacheSize);
+    
+    // build a LUT alongside every mesh (a dstWidth of 0 stops doing it)
+    void setLUT(float meshWidth, float meshHeight, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                ofxBezierWarpLUTFormat format = OFX_BEZIER_WARP_LUT_FLOAT, int fractionBits = 4);
+    
+    // the most recently finished mesh and LUT - call getMesh() first
+    // as that is what swaps a newly finished pair to the front
+    ofxBezierWarpMesh& getMesh();
+    ofxBezierWarpLUT& getLUT();
+    
+    // blocks until everything asked for so far has been built
+    void flush();
+    
+    bool isBusy();
+    unsigned int getNumPublished();
+    
+protected:
+	
+    void threadedFunction();
+    
+    struct Request {
+        vector<GLfloat> cntrlPoints;
+        ofxBezierWarpLattice lattice;
+        int numXPoints;
+        int numYPoints;
+        int gridDivX;
+        int gridDivY;
+        ofxBezierWarpMode mode;
+        bool bAdaptive;
+        float tolerance;
+        bool bUseSIMD;
+        bool bUseFixedEvaluators;
+        ofxBezierWarpIndexOutput indexOutput;
+        bool bUseShortIndices;
+        bool bUsePrimitiveRestart;
+        int vertexCacheSize;
+        float meshWidth;
+        float meshHeight;
+        int srcWidth;
+        int srcHeight;
+        int dstWidth;
+        int dstHeight;
+        ofxBezierWarpLUTFormat lutFormat;
+        int lutFractionBits;
+    };
+    
+    struct Slot {
+        ofxBezierWarpMesh mesh;
+        ofxBezierWarpLUT lut;
+    };
+    
+    void build(const Request & request, Slot & slot);
+    
+    Slot slots[3];
+    int front;
+    int ready;
+    int back;
+    
+    Request pending;
+    Request building;
+    
+    ofMutex swapMutex;
+    Poco::Condition workCondition;
+    Poco::Condition doneCondition;
+    
+    bool bRunning;
+    bool bPending;
+    bool bBuilding;
+    bool bReady;
+    unsigned int numPublished;
+    
+private:
+	
+};
+
+#endif
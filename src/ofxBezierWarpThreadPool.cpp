@@ -0,0 +1,172 @@
+/*
+ * ofxBezierWarpThreadPool.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#include "ofxBezierWarpThreadPool.h"
+#include "Poco/Environment.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpThreadPool::Worker::Worker(ofxBezierWarpThreadPool * _pool){
+    pool = _pool;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpThreadPool::Worker::threadedFunction(){
+    int generationSeen = 0;
+    while(isThreadRunning()){
+        if(!pool->waitForWork(generationSeen)) break;
+        pool->processTasks();
+    }
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpThreadPool::ofxBezierWarpThreadPool(){
+    currentJob = NULL;
+    generation = 0;
+    nextTask = 0;
+    numTasks = 0;
+    numTasksDone = 0;
+    bRunning = false;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpThreadPool::~ofxBezierWarpThreadPool(){
+    close();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpThreadPool::setup(int numThreads){
+    
+    close();
+    
+    // the thread calling run() does work too so we need one less
+    if(numThreads <= 0) numThreads = getNumCores();
+    numThreads = numThreads - 1;
+    
+    bRunning = true;
+    
+    for(int i = 0; i < numThreads; i++){
+        Worker * worker = new Worker(this);
+        worker->startThread(true, false);
+        workers.push_back(worker);
+    }
+    
+    ofLogVerbose() << "Started bezier warp thread pool with " << getNumThreads() << " threads";
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpThreadPool::close(){
+    
+    if(!bRunning) return;
+    
+    poolMutex.lock();
+    bRunning = false;
+    poolMutex.unlock();
+    workCondition.broadcast();
+    
+    for(size_t i = 0; i < workers.size(); i++){
+        workers[i]->waitForThread(true);
+        delete workers[i];
+    }
+    
+    workers.clear();
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpThreadPool::run(ofxBezierWarpJob & job, int _numTasks){
+    
+    if(workers.size() == 0 || _numTasks < 2){
+        for(int i = 0; i < _numTasks; i++) job.process(i);
+        return;
+    }
+    
+    poolMutex.lock();
+    currentJob = &job;
+    nextTask = 0;
+    numTasks = _numTasks;
+    numTasksDone = 0;
+    generation++;
+    poolMutex.unlock();
+    
+    workCondition.broadcast();
+    
+    processTasks();
+    
+    poolMutex.lock();
+    while(numTasksDone < numTasks) doneCondition.wait(poolMutex);
+    currentJob = NULL;
+    poolMutex.unlock();
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpThreadPool::waitForWork(int & generationSeen){
+    poolMutex.lock();
+    while(bRunning && generation == generationSeen) workCondition.wait(poolMutex);
+    generationSeen = generation;
+    bool bStillRunning = bRunning;
+    poolMutex.unlock();
+    return bStillRunning;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpThreadPool::processTasks(){
+    
+    while(true){
+        
+        poolMutex.lock();
+        if(currentJob == NULL || nextTask >= numTasks){
+            poolMutex.unlock();
+            return;
+        }
+        ofxBezierWarpJob * job = currentJob;
+        int task = nextTask++;
+        poolMutex.unlock();
+        
+        job->process(task);
+        
+        poolMutex.lock();
+        bool bFinished = (++numTasksDone == numTasks);
+        poolMutex.unlock();
+        
+        if(bFinished) doneCondition.broadcast();
+    }
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpThreadPool::getNumThreads(){
+    return workers.size() + 1;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpThreadPool::getNumCores(){
+    return MAX(1, (int)Poco::Environment::processorCount());
+}
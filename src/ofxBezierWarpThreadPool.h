@@ -0,0 +1,102 @@
+/*
+ * ofxBezierWarpThreadPool.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+
+#ifndef _H_OFXBEZIERWARPTHREADPOOL
+#define _H_OFXBEZIERWARPTHREADPOOL
+
+#include "ofThread.h"
+#include "Poco/Condition.h"
+
+// a job is split into numTasks independent pieces of work (row bands,
+// tiles, batches of points...) which get handed out to the pool
+
+class ofxBezierWarpJob {
+    
+public:
+	
+    virtual ~ofxBezierWarpJob(){};
+    virtual void process(int task) = 0;
+    
+};
+
+// a handful of persistent worker threads so that splitting a frame
+// across cores doesn't cost a thread start/stop every time
+
+class ofxBezierWarpThreadPool {
+    
+public:
+	
+    ofxBezierWarpThreadPool();
+    ~ofxBezierWarpThreadPool();
+    
+    void setup(int numThreads = 0);
+    void close();
+    
+    // blocks until every task has been processed - the calling
+    // thread works on tasks too rather than sitting idle
+    void run(ofxBezierWarpJob & job, int numTasks);
+    
+    int getNumThreads();
+    
+    static int getNumCores();
+    
+protected:
+	
+    class Worker : public ofThread {
+    public:
+        Worker(ofxBezierWarpThreadPool * pool);
+        void threadedFunction();
+        ofxBezierWarpThreadPool * pool;
+    };
+    
+    bool waitForWork(int & generationSeen);
+    void processTasks();
+    
+    vector<Worker*> workers;
+    
+    ofMutex poolMutex;
+    Poco::Condition workCondition;
+    Poco::Condition doneCondition;
+    
+    ofxBezierWarpJob * currentJob;
+    int generation;
+    int nextTask;
+    int numTasks;
+    int numTasksDone;
+    bool bRunning;
+    
+private:
+	
+};
+
+#endif
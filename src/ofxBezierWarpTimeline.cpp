@@ -0,0 +1,302 @@
+/*
+ * ofxBezierWarpTimeline.cpp
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#include "ofxBezierWarpTimeline.h"
+#include "ofxBezierWarp.h"
+#include "ofxBezierWarpPreset.h"
+
+//--------------------------------------------------------------
+ofxBezierWarpTimeline::ofxBezierWarpTimeline(){
+    bLoop = false;
+    time = 0;
+    bDirty = true;
+    lutMeshWidth = lutMeshHeight = 0;
+    lutSrcWidth = lutSrcHeight = 0;
+    lutDstWidth = lutDstHeight = 0;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpTimeline::~ofxBezierWarpTimeline(){
+    clear();
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpTimeline::addKeyframe(float time, ofxBezierWarp & warp, ofxBezierWarpEasing easing){
+    Keyframe * keyframe = new Keyframe();
+    keyframe->time = time;
+    keyframe->easing = easing;
+    keyframe->cntrlPoints = warp.getControlPointsReference();
+    keyframe->lattice = warp.getLattice();
+    keyframe->numXPoints = warp.getNumXPoints();
+    keyframe->numYPoints = warp.getNumYPoints();
+    keyframe->gridDivX = warp.getGridDivisionsX();
+    keyframe->gridDivY = warp.getGridDivisionsY();
+    keyframe->mode = warp.getWarpMode();
+    keyframe->bAdaptive = warp.getWarpGridAdaptive();
+    keyframe->tolerance = warp.getWarpGridTolerance();
+    return insertKeyframe(keyframe);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpTimeline::addKeyframe(float time, ofxBezierWarpPreset & preset, ofxBezierWarpEasing easing){
+    
+    if(!preset.isAllocated()) return -1;
+    
+    const ofxBezierWarpPreset::Header & header = preset.getHeader();
+    
+    Keyframe * keyframe = new Keyframe();
+    keyframe->time = time;
+    keyframe->easing = easing;
+    keyframe->cntrlPoints.assign(preset.getControlPoints(), preset.getControlPoints() + preset.getNumControlPoints() * 3);
+    keyframe->numXPoints = header.numXPoints;
+    keyframe->numYPoints = header.numYPoints;
+    keyframe->gridDivX = header.gridDivX;
+    keyframe->gridDivY = header.gridDivY;
+    keyframe->mode = (ofxBezierWarpMode)header.warpMode;
+    keyframe->bAdaptive = header.bAdaptive != 0;
+    keyframe->tolerance = header.tolerance;
+    preset.applyToLattice(keyframe->lattice);
+    return insertKeyframe(keyframe);
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpTimeline::insertKeyframe(Keyframe * keyframe){
+    
+    // after any others at the same time so adding in order keeps order
+    int index = keyframes.size();
+    while(index > 0 && keyframes[index - 1]->time > keyframe->time) index--;
+    
+    keyframes.insert(keyframes.begin() + index, keyframe);
+    bDirty = true;
+    
+    return index;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::removeKeyframe(int index){
+    if(index < 0 || index >= (int)keyframes.size()) return;
+    delete keyframes[index];
+    keyframes.erase(keyframes.begin() + index);
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::clear(){
+    for(size_t i = 0; i < keyframes.size(); i++) delete keyframes[i];
+    keyframes.clear();
+    cntrlPoints.clear();
+    lattice = ofxBezierWarpLattice();
+    mesh.clear();
+    lut.clear();
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+int ofxBezierWarpTimeline::getNumKeyframes(){
+    return keyframes.size();
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpTimeline::getKeyframeTime(int index){
+    if(index < 0 || index >= (int)keyframes.size()) return 0;
+    return keyframes[index]->time;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpTimeline::getDuration(){
+    if(keyframes.size() == 0) return 0;
+    return keyframes.back()->time - keyframes.front()->time;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::setLoop(bool b){
+    bLoop = b;
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+bool ofxBezierWarpTimeline::getLoop(){
+    return bLoop;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::setLUT(float meshWidth, float meshHeight, int srcWidth, int srcHeight, int dstWidth, int dstHeight){
+    
+    lutMeshWidth = meshWidth;
+    lutMeshHeight = meshHeight;
+    lutSrcWidth = srcWidth;
+    lutSrcHeight = srcHeight;
+    lutDstWidth = dstWidth;
+    lutDstHeight = dstHeight;
+    
+    for(size_t i = 0; i < keyframes.size(); i++) keyframes[i]->lut.clear();
+    lut.clear();
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::setTime(float _time){
+    if(_time == time) return;
+    time = _time;
+    bDirty = true;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpTimeline::getTime(){
+    return time;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::apply(ofxBezierWarp & warp){
+    
+    if(bDirty) evaluate();
+    if(cntrlPoints.size() == 0) return;
+    
+    if(warp.getNumXPoints() != mesh.getNumXPoints() || warp.getNumYPoints() != mesh.getNumYPoints()){
+        warp.setWarpGrid(mesh.getNumXPoints(), mesh.getNumYPoints());
+    }
+    
+    warp.getControlPointsReference() = cntrlPoints;
+    
+    // presets don't carry a lattice so keep the warp's levels for editing
+    if(lattice.isSetup()){
+        warp.getLattice() = lattice;
+    }else{
+        warp.getLattice().clear();
+    }
+}
+
+//--------------------------------------------------------------
+vector<GLfloat>& ofxBezierWarpTimeline::getControlPointsReference(){
+    if(bDirty) evaluate();
+    return cntrlPoints;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpMesh& ofxBezierWarpTimeline::getMesh(){
+    if(bDirty) evaluate();
+    return mesh;
+}
+
+//--------------------------------------------------------------
+ofxBezierWarpLUT& ofxBezierWarpTimeline::getLUT(){
+    if(bDirty) evaluate();
+    return lut;
+}
+
+//--------------------------------------------------------------
+float ofxBezierWarpTimeline::ease(ofxBezierWarpEasing easing, float t){
+    
+    t = ofClamp(t, 0.0f, 1.0f);
+    
+    switch(easing){
+        case OFX_BEZIER_WARP_EASE_LINEAR:
+            return t;
+        case OFX_BEZIER_WARP_EASE_IN:
+            return t * t * t;
+        case OFX_BEZIER_WARP_EASE_OUT:
+            t = 1.0f - t;
+            return 1.0f - t * t * t;
+        case OFX_BEZIER_WARP_EASE_IN_OUT:
+            if(t < 0.5f) return 4.0f * t * t * t;
+            t = 2.0f - 2.0f * t;
+            return 1.0f - 0.5f * t * t * t;
+        case OFX_BEZIER_WARP_EASE_STEP:
+            return t < 1.0f ? 0.0f : 1.0f;
+    }
+    
+    return t;
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::prepare(Keyframe & keyframe){
+    
+    if(!keyframe.mesh.isAllocated()){
+        keyframe.mesh.setAdaptive(keyframe.bAdaptive, keyframe.tolerance);
+        keyframe.mesh.update(keyframe.cntrlPoints, keyframe.numXPoints, keyframe.numYPoints,
+                             keyframe.gridDivX, keyframe.gridDivY, keyframe.mode, &keyframe.lattice);
+    }
+    
+    if(lutDstWidth > 0 && lutDstHeight > 0 && !keyframe.lut.isAllocated() && keyframe.mesh.isAllocated()){
+        keyframe.lut.build(keyframe.mesh, lutMeshWidth, lutMeshHeight, lutSrcWidth, lutSrcHeight, lutDstWidth, lutDstHeight);
+    }
+}
+
+//--------------------------------------------------------------
+void ofxBezierWarpTimeline::evaluate(){
+    
+    bDirty = false;
+    
+    if(keyframes.size() == 0) return;
+    
+    float start = keyframes.front()->time;
+    float end = keyframes.back()->time;
+    float t = time;
+    
+    if(bLoop && end > start){
+        t = start + fmodf(t - start, end - start);
+        if(t < start) t += end - start;
+    }
+    
+    int k = 0;
+    while(k + 1 < (int)keyframes.size() && keyframes[k + 1]->time <= t) k++;
+    
+    Keyframe & a = *keyframes[k];
+    Keyframe & b = (k + 1 < (int)keyframes.size()) ? *keyframes[k + 1] : a;
+    
+    float amount = 0;
+    if(&a != &b && t > a.time) amount = ease(a.easing, (t - a.time) / (b.time - a.time));
+    
+    // nets of different sizes can't be mixed so hold the first one
+    if(a.cntrlPoints.size() == b.cntrlPoints.size()){
+        cntrlPoints.resize(a.cntrlPoints.size());
+        for(size_t i = 0; i < cntrlPoints.size(); i++){
+            cntrlPoints[i] = a.cntrlPoints[i] + amount * (b.cntrlPoints[i] - a.cntrlPoints[i]);
+        }
+    }else{
+        cntrlPoints = a.cntrlPoints;
+    }
+    
+    if(!lattice.blend(a.lattice, b.lattice, amount)) lattice = a.lattice;
+    
+    prepare(a);
+    prepare(b);
+    
+    if(!mesh.blend(a.mesh, b.mesh, amount)){
+        mesh.setAdaptive(a.bAdaptive, a.tolerance);
+        mesh.update(cntrlPoints, a.numXPoints, a.numYPoints, a.gridDivX, a.gridDivY, a.mode, &lattice);
+    }
+    
+    if(lutDstWidth > 0 && lutDstHeight > 0 && !lut.blend(a.lut, b.lut, amount)){
+        lut.build(mesh, lutMeshWidth, lutMeshHeight, lutSrcWidth, lutSrcHeight, lutDstWidth, lutDstHeight);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * ofxBezierWarpTimeline.h
+ *
+ * Copyright 2013 (c) Matthew Gingold http://gingold.com.au
+ * Adapted from: http://forum.openframeworks.cc/index.php/topic,4002.0.html
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * If you're using this software for something cool consider sending 
+ * me an email to let me know about your project: m@gingold.com.au
+ *
+ */
+#ifndef _H_OFXBEZIERWARPTIMELINE
+#define _H_OFXBEZIERWARPTIMELINE
+
+#include "ofxBezierWarpMesh.h"
+#include "ofxBezierWarpLUT.h"
+
+class ofxBezierWarp;
+class ofxBezierWarpPreset;
+
+enum ofxBezierWarpEasing {
+    OFX_BEZIER_WARP_EASE_LINEAR = 0,
+    OFX_BEZIER_WARP_EASE_IN,            // cubic
+    OFX_BEZIER_WARP_EASE_OUT,
+    OFX_BEZIER_WARP_EASE_IN_OUT,
+    OFX_BEZIER_WARP_EASE_STEP           // hold until the next keyframe
+};
+
+// keyframed control nets for animating between calibrations. Every
+// keyframe keeps its own evaluated mesh (and LUT if asked for) so when
+// two neighbouring keyframes share a topology the in between frames are
+// a straight mix of those instead of evaluating the surface again. When
+// they don't (different grids, modes or adaptive meshes) the mixed net
+// goes through the normal incremental mesh update, and keyframes with
+// different numbers of control points just hold until the next one
+
+class ofxBezierWarpTimeline {
+    
+public:
+	
+    ofxBezierWarpTimeline();
+    ~ofxBezierWarpTimeline();
+    
+    // keyframes are kept in time order - the easing is used
+    // on the way from this keyframe to the next one
+    int addKeyframe(float time, ofxBezierWarp & warp, ofxBezierWarpEasing easing = OFX_BEZIER_WARP_EASE_LINEAR);
+    int addKeyframe(float time, ofxBezierWarpPreset & preset, ofxBezierWarpEasing easing = OFX_BEZIER_WARP_EASE_LINEAR);
+    void removeKeyframe(int index);
+    void clear();
+    
+    int getNumKeyframes();
+    float getKeyframeTime(int index);
+    float getDuration();
+    
+    void setLoop(bool b);
+    bool getLoop();
+    
+    // also build a float LUT for every keyframe and blend those
+    // (a dstWidth of 0 turns it off again)
+    void setLUT(float meshWidth, float meshHeight, int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    
+    void setTime(float time);
+    float getTime();
+    
+    // copies the current in between control points into the warp
+    void apply(ofxBezierWarp & warp);
+    
+    vector<GLfloat>& getControlPointsReference();
+    ofxBezierWarpMesh& getMesh();
+    ofxBezierWarpLUT& getLUT();
+    
+    static float ease(ofxBezierWarpEasing easing, float t);
+    
+protected:
+	
+    struct Keyframe {
+        float time;
+        ofxBezierWarpEasing easing;
+        vector<GLfloat> cntrlPoints;
+        ofxBezierWarpLattice lattice;
+        int numXPoints;
+        int numYPoints;
+        int gridDivX;
+        int gridDivY;
+        ofxBezierWarpMode mode;
+        bool bAdaptive;
+        float tolerance;
+        ofxBezierWarpMesh mesh;
+        ofxBezierWarpLUT lut;
+    };
+    
+    int insertKeyframe(Keyframe * keyframe);
+    void prepare(Keyframe & keyframe);
+    void evaluate();
+    
+    vector<Keyframe*> keyframes;
+    
+    bool bLoop;
+    float time;
+    bool bDirty;
+    
+    float lutMeshWidth;
+    float lutMeshHeight;
+    int lutSrcWidth;
+    int lutSrcHeight;
+    int lutDstWidth;
+    int lutDstHeight;
+    
+    vector<GLfloat> cntrlPoints;
+    ofxBezierWarpLattice lattice;
+    ofxBezierWarpMesh mesh;
+    ofxBezierWarpLUT lut;
+    
+private:
+	
+};
+
+#endif